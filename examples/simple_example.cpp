@@ -11,24 +11,8 @@
 
 using namespace pubsub;
 
-// Simple message serializer implementation
-class SimpleSerializer : public MessageSerializer {
-public:
-    std::vector<uint8_t> serialize(const std::any& payload) const override {
-        try {
-            const std::string& str = std::any_cast<std::string>(payload);
-            std::vector<uint8_t> data(str.begin(), str.end());
-            return data;
-        } catch (const std::bad_any_cast&) {
-            return {};
-        }
-    }
-    
-    std::any deserialize(const std::vector<uint8_t>& data) const override {
-        std::string str(data.begin(), data.end());
-        return str;
-    }
-};
+// Serializer for the payload types used in this example
+using SimpleSerializer = TypedSerializer<std::string>;
 
 int main() {
     // Initialize the PubSub library
@@ -3,24 +3,75 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <set>
 #include <string>
 #include <string_view>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
+#include "pubsub/federation.hpp"
+#include "pubsub/interceptor.hpp"
+#include "pubsub/memory.hpp"
+#include "pubsub/ring_buffer.hpp"
 #include "pubsub/subscription.hpp"
+#include "pubsub/subscription_table.hpp"
+#include "pubsub/topic.hpp"
 
 namespace pubsub {
 
+class DuplicateFilter;
 class Message;
+class MessageSerializer;
+class PublishRecorder;
+class Snapshot;
+class SubscriptionGroup;
 class Topic;
+class TopicAutomaton;
 class BrokerDeleter;
 
+/**
+ * @brief What the broker does when a queue or memory limit would be exceeded
+ */
+enum class OverflowPolicy {
+    /**
+     * @brief Reject the message being published
+     */
+    DropNewest,
+    
+    /**
+     * @brief Evict the oldest queued messages to make room
+     */
+    DropOldest
+};
+
+/**
+ * @brief How published messages are handed to the worker threads
+ */
+enum class DispatchEngine {
+    /**
+     * @brief Shared queue guarded by a mutex and condition variable
+     */
+    Queue,
+    
+    /**
+     * @brief Pre-allocated ring of slots with sequence barriers (see RingBuffer)
+     *
+     * One routing thread matches published slots in sequence order, then the
+     * worker threads deliver them, each taking every thread_count-th sequence.
+     * Handoff is lock-free and allocation-free once the slots have warmed up.
+     */
+    Ring
+};
+
 /**
  * @brief Configuration options for the broker
  */
@@ -35,6 +86,94 @@ struct BrokerConfig {
      */
     size_t max_queue_size = 10000;
     
+    /**
+     * @brief Maximum approximate bytes held by queued messages (0 = unlimited)
+     */
+    size_t max_queue_bytes = 0;
+    
+    /**
+     * @brief Maximum approximate bytes held by queued, in-flight and retained messages (0 = unlimited)
+     *
+     * Retention never grows past the budget: a topic first evicts its own
+     * oldest retained messages and otherwise skips retaining the new one.
+     */
+    size_t memory_budget_bytes = 0;
+    
+    /**
+     * @brief Policy applied when a queue or memory limit would be exceeded
+     */
+    OverflowPolicy overflow_policy = OverflowPolicy::DropNewest;
+    
+    /**
+     * @brief Engine handing published messages to the worker threads
+     */
+    DispatchEngine dispatch_engine = DispatchEngine::Queue;
+    
+    /**
+     * @brief Number of slots of the ring engine (rounded up to a power of two)
+     *
+     * Replaces max_queue_size for DispatchEngine::Ring. A ring cannot evict,
+     * so when it is full OverflowPolicy::DropNewest rejects the message and
+     * OverflowPolicy::DropOldest makes the publisher wait for a free slot.
+     * Byte limits still apply.
+     */
+    size_t ring_capacity = 65536;
+    
+    /**
+     * @brief Whether workers take messages from the shared queue in adaptive batches
+     *
+     * While the queue stays deeper than batch_queue_threshold the batch size
+     * doubles, up to max_batch_size; as the queue drains it halves back to a
+     * single message, so light traffic is still delivered immediately. A batch
+     * matches all its messages under one lock acquisition.
+     */
+    bool adaptive_batching = false;
+    
+    /**
+     * @brief Largest number of messages a worker takes at once
+     */
+    size_t max_batch_size = 256;
+    
+    /**
+     * @brief Queue depth above which the batch size grows
+     */
+    size_t batch_queue_threshold = 64;
+    
+    /**
+     * @brief Maximum delay in microseconds that batching may add to the last message of a batch
+     *
+     * The batch size is capped so that the measured per-message cost times the
+     * batch size stays within this bound.
+     */
+    uint64_t max_batch_latency_us = 1000;
+    
+    /**
+     * @brief Messages a publishing thread stages before handing them to the broker at once (0 = publish directly)
+     *
+     * Each thread appends to its own buffer, which is flushed in one queue
+     * operation when it holds this many messages, when the maintenance thread
+     * finds its oldest message older than publish_staging_us, on flush() and
+     * on shutdown(). A thread's messages keep their order. Messages staged
+     * after shutdown() has started are dropped. publish() returns true once a message is
+     * staged; messages dropped at flush time are counted in
+     * BrokerStats::dropped_messages. publish_async() is never staged.
+     */
+    size_t publish_staging_size = 0;
+    
+    /**
+     * @brief Maximum time in microseconds a message stays staged (0 = until the buffer fills or flush())
+     */
+    uint64_t publish_staging_us = 1000;
+    
+    /**
+     * @brief Back the message queue, topic and subscription tables, routing indexes and new messages with huge pages
+     *
+     * Allocations come from a process-wide HugePageArena, which falls back to
+     * normal pages when huge pages are unavailable. Messages created with
+     * Message::create() use it as well (see Message::set_memory_resource()).
+     */
+    HugePageMode huge_pages = HugePageMode::Disabled;
+    
     /**
      * @brief Whether to retain messages for late subscribers
      */
@@ -45,10 +184,156 @@ struct BrokerConfig {
      */
     size_t max_retained_messages = 100;
     
+    /**
+     * @brief Whether to match topics against all subscription patterns at once (see TopicAutomaton)
+     *
+     * Instead of evaluating each subscription's filter in turn, the patterns
+     * are compiled into one automaton over topic levels that finds every
+     * matching subscription in a single pass over the topic. Worth enabling
+     * with many (especially wildcard) subscriptions. Shared subscription
+     * groups are still matched one by one.
+     */
+    bool topic_automaton = false;
+    
+    /**
+     * @brief Number of cached automaton states, beyond one per pattern level, above which the cache is rebuilt
+     */
+    size_t topic_automaton_max_states = 4096;
+    
     /**
      * @brief Whether to use strict topic matching
      */
     bool strict_topic_matching = false;
+    
+    /**
+     * @brief Whether to drop republished duplicates of recently seen messages
+     *
+     * A key is remembered when its message is admitted and forgotten again
+     * if a queue or memory limit then rejects the message, so the producer
+     * can retry. A duplicate arriving in between is still suppressed, and
+     * neither copy is delivered unless the rejected one is retried.
+     */
+    bool deduplicate_messages = false;
+    
+    /**
+     * @brief Minimum number of recent message keys remembered for deduplication
+     */
+    size_t dedup_window_size = 65536;
+    
+    /**
+     * @brief Maximum age of remembered message keys in milliseconds (0 = count bound only)
+     */
+    uint64_t dedup_window_ms = 0;
+    
+    /**
+     * @brief Header carrying the deduplication key (empty = use the message ID)
+     */
+    std::string dedup_header;
+    
+    /**
+     * @brief Whether deduplication keys are scoped per topic instead of per broker
+     */
+    bool dedup_per_topic = false;
+    
+    /**
+     * @brief Header carrying the partition key of messages on partitioned topics
+     */
+    std::string partition_key_header = "partition-key";
+    
+    /**
+     * @brief Number of ordered worker lanes serving partitions (0 = thread_count)
+     */
+    size_t partition_lanes = 0;
+    
+    /**
+     * @brief Snapshot file of topics and retained messages (empty = no snapshots)
+     *
+     * An existing snapshot is mapped by initialize() and its retained messages
+     * are served lazily; a final snapshot is written on shutdown.
+     */
+    std::string snapshot_path;
+    
+    /**
+     * @brief Interval between periodic snapshots in milliseconds (0 = only on shutdown)
+     */
+    uint64_t snapshot_interval_ms = 0;
+    
+    /**
+     * @brief Serializer for retained payloads in snapshots (null = keep Buffer payloads only)
+     */
+    std::shared_ptr<MessageSerializer> snapshot_serializer;
+    
+    /**
+     * @brief Idle time in milliseconds after which an empty topic is evicted (0 = never)
+     *
+     * Only topics without retained messages, subscriptions or partitions are
+     * evicted; they are recreated on demand. The topic map is swept
+     * incrementally in the background, a few buckets at a time.
+     */
+    uint64_t topic_idle_timeout_ms = 0;
+    
+    /**
+     * @brief Number of topic map buckets examined per eviction step
+     */
+    size_t topic_gc_batch = 64;
+    
+    /**
+     * @brief Capture file recording every publish call (empty = no capture)
+     */
+    std::string capture_path;
+    
+    /**
+     * @brief Serializer for captured payloads (null = keep Buffer payloads only)
+     */
+    std::shared_ptr<MessageSerializer> capture_serializer;
+    
+    /**
+     * @brief Interceptors run on every message before routing, in order
+     *
+     * They run ahead of the topic-level interceptors added with
+     * Broker::add_interceptor().
+     */
+    std::vector<std::shared_ptr<MessageInterceptor>> interceptors;
+};
+
+/**
+ * @brief Outcome of an asynchronous publish
+ */
+struct DeliveryReport {
+    /**
+     * @brief Whether publish accepted the message (false if rejected by limits or shutdown)
+     */
+    bool accepted = false;
+    
+    /**
+     * @brief Whether the queued message was evicted by OverflowPolicy::DropOldest
+     */
+    bool evicted = false;
+    
+    /**
+     * @brief Number of subscriptions whose callback completed (or was handed to its executor)
+     */
+    size_t delivered = 0;
+    
+    /**
+     * @brief Number of subscriptions whose filter did not match
+     */
+    size_t filtered = 0;
+    
+    /**
+     * @brief Number of subscriptions that were inactive, over their message limit or whose executor refused the callback
+     */
+    size_t rejected = 0;
+    
+    /**
+     * @brief Number of subscriptions whose callback threw
+     */
+    size_t errored = 0;
+    
+    /**
+     * @brief Whether an interceptor dropped the message before routing
+     */
+    bool intercepted = false;
 };
 
 /**
@@ -65,6 +350,11 @@ struct BrokerStats {
      */
     size_t subscription_count = 0;
     
+    /**
+     * @brief Number of shared subscription groups
+     */
+    size_t shared_group_count = 0;
+    
     /**
      * @brief Number of messages published
      */
@@ -80,10 +370,95 @@ struct BrokerStats {
      */
     size_t queued_messages = 0;
     
+    /**
+     * @brief Approximate bytes held by queued messages
+     */
+    size_t queued_bytes = 0;
+    
+    /**
+     * @brief Approximate bytes held by messages being processed
+     */
+    size_t in_flight_bytes = 0;
+    
+    /**
+     * @brief Approximate bytes held by retained messages
+     */
+    size_t retained_bytes = 0;
+    
+    /**
+     * @brief Number of messages rejected or evicted by queue and memory limits
+     */
+    size_t dropped_messages = 0;
+    
+    /**
+     * @brief Number of published messages dropped as duplicates
+     */
+    size_t duplicate_messages = 0;
+    
+    /**
+     * @brief Number of messages dropped by interceptors
+     */
+    size_t intercepted_messages = 0;
+    
+    /**
+     * @brief Number of idle topics evicted
+     */
+    size_t evicted_topics = 0;
+    
+    /**
+     * @brief Number of connected federation peers
+     */
+    size_t federation_peers = 0;
+    
+    /**
+     * @brief Number of messages forwarded to federation peers (one per peer)
+     */
+    size_t forwarded_messages = 0;
+    
     /**
      * @brief Number of worker threads
      */
     size_t worker_threads = 0;
+    
+    /**
+     * @brief Current adaptive batch size (1 = messages are delivered one at a time)
+     */
+    size_t batch_size = 1;
+    
+    /**
+     * @brief Smoothed processing cost per message in nanoseconds, as measured by batching
+     */
+    uint64_t batch_message_cost_ns = 0;
+    
+    /**
+     * @brief Number of messages processed as part of a batch larger than one
+     */
+    size_t batched_messages = 0;
+    
+    /**
+     * @brief Number of messages currently staged by publishing threads
+     */
+    size_t staged_messages = 0;
+    
+    /**
+     * @brief Number of staging buffer flushes
+     */
+    size_t staging_flushes = 0;
+    
+    /**
+     * @brief Bytes mapped by the huge page arena (0 when huge pages are disabled)
+     */
+    size_t arena_mapped_bytes = 0;
+    
+    /**
+     * @brief Bytes of the arena mapped as explicit huge pages or advised as transparent ones
+     */
+    size_t arena_huge_page_bytes = 0;
+    
+    /**
+     * @brief Number of ordered lanes serving partitioned topics
+     */
+    size_t partition_lanes = 0;
 };
 
 /**
@@ -120,14 +495,78 @@ public:
     
     /**
      * @brief Publish a message to a topic
+     *
+     * When deduplication is enabled, a message whose key was already seen
+     * within the configured window is acknowledged but not delivered.
+     *
      * @param topic Topic name
      * @param message Message to publish
      * @return true if the message was published successfully
      */
     bool publish(std::string_view topic, std::shared_ptr<Message> message);
     
+    /**
+     * @brief Callback receiving the outcome of an asynchronous publish
+     */
+    using PublishCallback = std::function<void(const DeliveryReport&)>;
+    
+    /**
+     * @brief Publish a message and get notified once it has been delivered
+     *
+     * The callback runs exactly once: after every matched subscription's
+     * deliver() has returned, immediately if the message is rejected or
+     * suppressed as a duplicate, or when the message is evicted from the
+     * queue. It runs on a worker thread or the calling thread.
+     *
+     * @param topic Topic name
+     * @param message Message to publish
+     * @param on_complete Completion callback
+     * @return true if the message was published successfully
+     */
+    bool publish_async(std::string_view topic, std::shared_ptr<Message> message, PublishCallback on_complete);
+    
+    /**
+     * @brief Publish a message and get a future for its delivery outcome
+     * @param topic Topic name
+     * @param message Message to publish
+     * @return Future resolved once the message has been delivered or dropped
+     */
+    std::future<DeliveryReport> publish_async(std::string_view topic, std::shared_ptr<Message> message);
+    
+    /**
+     * @brief Hand the messages staged by the calling thread to the broker
+     *
+     * Only needed with BrokerConfig::publish_staging_size; staged messages are
+     * otherwise flushed when the buffer fills or ages.
+     *
+     * @return Number of messages flushed
+     */
+    size_t flush();
+    
     /**
      * @brief Create a subscription to a topic pattern
+     *
+     * A pattern of the form "$share/<group>/<filter>" joins a shared
+     * subscription group: each matching message is delivered to exactly one
+     * member of the group, chosen by SubscriptionOptions::share_strategy.
+     *
+     * @param topic_pattern Topic pattern to subscribe to
+     * @param callback Callback function for message delivery
+     * @param options Subscription options
+     * @return Shared pointer to the subscription
+     */
+    std::shared_ptr<Subscription> subscribe(
+        std::string_view topic_pattern,
+        Subscription::MessageCallback callback,
+        const SubscriptionOptions& options = {}
+    );
+    
+    /**
+     * @brief Create a subscription whose callback borrows the message
+     *
+     * The callback receives the message by reference and must not keep it
+     * beyond the call; deliveries then involve no reference counting.
+     *
      * @param topic_pattern Topic pattern to subscribe to
      * @param callback Callback function for message delivery
      * @param options Subscription options
@@ -135,10 +574,56 @@ public:
      */
     std::shared_ptr<Subscription> subscribe(
         std::string_view topic_pattern,
-        std::function<void(std::shared_ptr<Message>)> callback,
+        Subscription::MessageRefCallback callback,
         const SubscriptionOptions& options = {}
     );
     
+    /**
+     * @brief Create a subscription from any callable accepting a message reference
+     *
+     * Picks the borrowing overload for callables that would fit both
+     * callback types, such as generic lambdas.
+     *
+     * @param topic_pattern Topic pattern to subscribe to
+     * @param callback Callable invocable with a const Message&
+     * @param options Subscription options
+     * @return Shared pointer to the subscription
+     */
+    template<typename Callback,
+             typename = std::enable_if_t<
+                 std::is_invocable_v<Callback&, const Message&> &&
+                 !std::is_same_v<std::decay_t<Callback>, Subscription::MessageCallback> &&
+                 !std::is_same_v<std::decay_t<Callback>, Subscription::MessageRefCallback>>>
+    std::shared_ptr<Subscription> subscribe(
+        std::string_view topic_pattern,
+        Callback&& callback,
+        const SubscriptionOptions& options = {}
+    ) {
+        return subscribe(topic_pattern, Subscription::MessageRefCallback(std::forward<Callback>(callback)), options);
+    }
+    
+    /**
+     * @brief Split a topic into ordered partitions
+     *
+     * Messages published to a partitioned topic are placed in a partition by
+     * hashing the partition key header (or round-robin when absent). Each
+     * partition is served by a single worker lane, so messages within a
+     * partition are delivered strictly in order while different partitions
+     * are processed concurrently.
+     *
+     * @param topic Topic name
+     * @param partitions Number of partitions
+     * @return true if the topic is partitioned with the requested count
+     */
+    bool create_partitioned_topic(std::string_view topic, size_t partitions);
+    
+    /**
+     * @brief Get per-partition statistics of a partitioned topic
+     * @param topic Topic name
+     * @return Vector of partition statistics (empty if the topic is not partitioned)
+     */
+    std::vector<PartitionStats> get_partition_stats(std::string_view topic) const;
+    
     /**
      * @brief Unsubscribe from a topic
      * @param subscription Subscription to cancel
@@ -146,6 +631,23 @@ public:
      */
     bool unsubscribe(std::shared_ptr<Subscription> subscription);
     
+    /**
+     * @brief Start recording publish calls into a capture file
+     *
+     * Replaces any capture in progress. Captures can be replayed with
+     * replay_capture() or the pubsub-replay tool.
+     *
+     * @param path Capture file to create
+     * @param serializer Payload serializer (null = keep Buffer payloads only)
+     * @return true if the capture file was created
+     */
+    bool start_capture(const std::string& path, std::shared_ptr<MessageSerializer> serializer = nullptr);
+    
+    /**
+     * @brief Stop recording publish calls
+     */
+    void stop_capture();
+    
     /**
      * @brief Get statistics about the broker
      * @return Broker statistics
@@ -163,6 +665,89 @@ public:
      */
     void clear_retained_messages();
     
+    /**
+     * @brief Get the retained messages of a topic
+     * @param topic Topic name
+     * @return Retained messages, oldest first
+     */
+    std::vector<std::shared_ptr<Message>> get_retained_messages(std::string_view topic);
+    
+    /**
+     * @brief Write the topic registry and retained messages to a snapshot file
+     *
+     * Topics still held only in the mapped startup snapshot are copied over
+     * without being decoded.
+     *
+     * @param path Destination (empty = BrokerConfig::snapshot_path)
+     * @return true if the snapshot was written
+     */
+    bool save_snapshot(const std::string& path = {});
+    
+    /**
+     * @brief Connect a federated peer broker
+     *
+     * The peer immediately receives the current local interest and then
+     * every change to it. Locally published messages matching the peer's
+     * advertised interest are forwarded through the link. Federation
+     * assumes a full mesh: messages received from a peer are delivered
+     * locally but never forwarded to other peers.
+     *
+     * @param link Transport to the peer
+     * @return Peer ID
+     */
+    std::string add_federation_peer(std::shared_ptr<FederationLink> link);
+    
+    /**
+     * @brief Disconnect a federated peer
+     * @param peer_id ID returned by add_federation_peer()
+     * @return true if the peer was connected
+     */
+    bool remove_federation_peer(const std::string& peer_id);
+    
+    /**
+     * @brief Apply an interest change advertised by a peer
+     * @param peer_id ID of the advertising peer
+     * @param change Added and removed patterns
+     * @return true if the peer is connected
+     */
+    bool update_peer_interest(const std::string& peer_id, const InterestChange& change);
+    
+    /**
+     * @brief Publish a message received from a peer
+     * @param topic Topic to publish to
+     * @param message Message to publish
+     * @return true if the message was published successfully
+     */
+    bool publish_from_peer(std::string_view topic, std::shared_ptr<Message> message);
+    
+    /**
+     * @brief Get the interest advertised to peers
+     * @return Minimal set of local subscription patterns
+     */
+    std::vector<std::string> get_local_interest() const;
+    
+    /**
+     * @brief Intercept messages published to topics matching a pattern
+     *
+     * Topic-level interceptors run after BrokerConfig::interceptors, in the
+     * order they were added. The interceptor list is copied on change, so
+     * workers read it without locking. While interceptors are installed,
+     * federated peers receive a copy of the message as published, which
+     * interceptors never modify.
+     *
+     * @param topic_pattern Topic pattern (exact or with wildcards)
+     * @param interceptor Interceptor to run
+     * @return Interceptor ID (empty if interceptor is null)
+     */
+    std::string add_interceptor(std::string_view topic_pattern, std::shared_ptr<MessageInterceptor> interceptor);
+    
+    /**
+     * @brief Remove a topic-level interceptor
+     * @param interceptor_id ID returned by add_interceptor()
+     * @return true if the interceptor was registered
+     */
+    bool remove_interceptor(const std::string& interceptor_id);
+    
 protected:
     /**
      * @brief Destructor
@@ -175,6 +760,146 @@ private:
      */
     Broker();
     
+    /**
+     * @brief Pending notification of an asynchronous publish
+     */
+    struct PublishCompletion {
+        PublishCallback callback;
+        DeliveryReport report;
+    };
+    
+    /**
+     * @brief Invoke a completion callback, swallowing its exceptions
+     * @param completion Completion to finish
+     */
+    static void finish_publish(PublishCompletion& completion);
+    
+    /**
+     * @brief Publish a message, forwarding it to interested peers unless it came from one
+     * @param topic Topic to publish to
+     * @param message Message to publish
+     * @param from_peer Whether the message was received from a peer
+     * @param completion Completion of an asynchronous publish (null for plain publish)
+     * @return true if the message was published successfully
+     */
+    bool publish_message(std::string_view topic, std::shared_ptr<Message> message, bool from_peer,
+                         std::shared_ptr<PublishCompletion> completion = nullptr);
+    
+    /**
+     * @brief Run the steps every publish takes before the shared queue
+     *
+     * Captures the message, suppresses duplicates, forwards it to peers and
+     * routes partitioned topics to their lane.
+     *
+     * @param topic Topic to publish to
+     * @param message Message to publish (moved from if handled)
+     * @param from_peer Whether the message was received from a peer
+     * @param completion Completion of an asynchronous publish (may be null)
+     * @return The publish result if the message was handled, nullopt if it still has to be queued
+     */
+    std::optional<bool> admit_message(std::string_view topic, std::shared_ptr<Message>& message, bool from_peer,
+                                      std::shared_ptr<PublishCompletion>& completion);
+    
+    /**
+     * @brief Forget the deduplication key of a message that was admitted but then rejected
+     *
+     * Without this a producer retrying a publish dropped for queue or memory
+     * limits would have the retry suppressed as a duplicate. Duplicates
+     * suppressed while the message was pending are not remembered; only the
+     * retry of the rejected message gets through.
+     *
+     * @param topic Topic the message was published to
+     * @param message Rejected message
+     */
+    void forget_duplicate(std::string_view topic, const Message& message);
+    
+    /**
+     * @brief Get the deduplication key of a message
+     * @param message Message to key
+     * @param storage Holds the key when it is taken from a header
+     * @return The configured header's value, or the message ID
+     */
+    std::string_view dedup_key(const Message& message, std::string& storage) const;
+    
+    /**
+     * @brief Queue a message on the shared queue within the queue and memory limits
+     * @param topic Topic of the message
+     * @param message Message to queue
+     * @param bytes Approximate size of the message
+     * @param completion Completion of an asynchronous publish (may be null)
+     * @return true if the message was queued
+     */
+    bool enqueue_message(std::string_view topic, std::shared_ptr<Message> message, size_t bytes,
+                         std::shared_ptr<PublishCompletion> completion);
+    
+    /**
+     * @brief A message waiting in a publisher's staging buffer
+     */
+    struct StagedMessage {
+        std::shared_ptr<Message> message;
+        std::string topic;  // Only set when it differs from message->topic()
+        bool own_topic = false;
+        
+        /**
+         * @brief Get the topic the message was published to
+         * @return Topic name
+         */
+        std::string_view topic_name() const;
+    };
+    
+    /**
+     * @brief Per-thread staging buffer
+     *
+     * The mutex is only contended when the maintenance thread flushes an
+     * aged buffer.
+     */
+    struct StagingBuffer {
+        std::mutex mutex;
+        std::vector<StagedMessage> messages;
+        uint64_t oldest_ticks = 0;
+    };
+    
+    /**
+     * @brief Get the calling thread's staging buffer, registering it on first use
+     * @return Staging buffer
+     */
+    StagingBuffer& local_staging_buffer();
+    
+    /**
+     * @brief Append a message to the calling thread's staging buffer
+     * @param topic Topic to publish to
+     * @param message Message to publish
+     * @return true (the message is accepted into the buffer)
+     */
+    bool stage_message(std::string_view topic, std::shared_ptr<Message> message);
+    
+    /**
+     * @brief Publish the staged messages of a buffer in order (buffer mutex must be held)
+     * @param buffer Staging buffer
+     * @return Number of messages flushed
+     */
+    size_t flush_staging(StagingBuffer& buffer);
+    
+    /**
+     * @brief Flush the staging buffers of all threads
+     * @param aged_only Only flush buffers whose oldest message exceeded publish_staging_us
+     */
+    void flush_staging_buffers(bool aged_only);
+    
+    /**
+     * @brief Forward a message to the peers interested in its topic
+     * @param topic Topic of the message
+     * @param message Message to forward
+     */
+    void forward_to_peers(std::string_view topic, const std::shared_ptr<Message>& message);
+    
+    /**
+     * @brief Update the local interest and notify every peer
+     * @param pattern Subscription pattern
+     * @param subscribed true for a new subscription, false for a removed one
+     */
+    void update_local_interest(const std::string& pattern, bool subscribed);
+    
     /**
      * @brief Get or create a topic
      * @param topic_name Topic name
@@ -182,16 +907,352 @@ private:
      */
     std::shared_ptr<Topic> get_or_create_topic(std::string_view topic_name);
     
+    /**
+     * @brief Get or create a topic through a small per-thread cache
+     *
+     * Routing threads retain into the same few topics over and over; the
+     * cache skips topics_mutex_ and the key allocation for those. Entries
+     * are dropped whenever topics_generation_ moves.
+     *
+     * @param topic_name Topic name
+     * @return Shared pointer to the topic
+     */
+    std::shared_ptr<Topic> cached_topic(std::string_view topic_name);
+    
+    /**
+     * @brief Create a topic from the startup snapshot (topics_mutex_ must be held)
+     * @param topic_name Topic name
+     * @return The materialized topic, or nullptr if the snapshot does not contain it
+     */
+    std::shared_ptr<Topic> materialize_snapshot_topic(const std::string& topic_name);
+    
+    /**
+     * @brief Deliver retained messages of matching topics to a new subscription
+     * @param subscription New subscription
+     */
+    void deliver_retained(const std::shared_ptr<Subscription>& subscription);
+    
+    /**
+     * @brief Register a new subscription and replay retained messages to it
+     * @param subscription Subscription to register
+     * @return The registered subscription
+     */
+    std::shared_ptr<Subscription> add_subscription(std::shared_ptr<Subscription> subscription);
+    
+    /**
+     * @brief Housekeeping thread function (periodic snapshots, idle topic eviction)
+     */
+    void maintenance_thread();
+    
+    /**
+     * @brief Evict idle topics from the next few buckets of the topic map
+     * @param max_buckets Number of buckets to examine
+     * @return Number of topics evicted
+     */
+    size_t collect_idle_topics(size_t max_buckets);
+    
+    /**
+     * @brief Check whether any subscription or share group matches a topic (subscriptions_mutex_ must be held)
+     * @param topic_name Topic name
+     * @return true if a message on the topic would be delivered somewhere
+     */
+    bool has_subscribers(std::string_view topic_name);
+    
+    /**
+     * @brief A message waiting on a partition lane
+     */
+    struct PartitionedMessage {
+        std::shared_ptr<Message> message;
+        size_t bytes = 0;
+        std::shared_ptr<Topic> topic;
+        size_t partition = 0;
+        std::shared_ptr<PublishCompletion> completion;
+    };
+    
+    /**
+     * @brief A message waiting on the shared queue
+     */
+    struct QueuedMessage {
+        std::shared_ptr<Message> message;
+        size_t bytes = 0;
+        std::shared_ptr<PublishCompletion> completion;
+    };
+    
+    // Containers that move onto the huge page arena when it is enabled
+    using MessageQueue = std::queue<QueuedMessage, std::deque<QueuedMessage, ArenaAllocator<QueuedMessage>>>;
+    
+    template<typename Value>
+    using ArenaMap = std::unordered_map<std::string, Value, std::hash<std::string>, std::equal_to<std::string>,
+                                        ArenaAllocator<std::pair<const std::string, Value>>>;
+    
+    /**
+     * @brief An ordered worker lane serving a subset of partitions
+     *
+     * Publishers hold a reference while queuing, so a lane outlives its
+     * removal from lanes_; once stopped it rejects new messages and its
+     * thread exits after draining the queue.
+     */
+    struct PartitionLane {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::queue<PartitionedMessage> queue;
+        bool stopped = false;
+        std::thread thread;
+    };
+    
     /**
      * @brief Worker thread function
      */
     void worker_thread();
     
+    /**
+     * @brief Partition lane thread function
+     * @param lane Lane served by this thread
+     */
+    void lane_thread(PartitionLane& lane);
+    
+    /**
+     * @brief Start the partition lanes if they are not running yet
+     */
+    void start_partition_lanes();
+    
+    /**
+     * @brief Stop and join the partition lanes
+     */
+    void stop_partition_lanes();
+    
+    /**
+     * @brief Queue a message on the lane of its partition
+     * @param topic Partitioned topic
+     * @param message Message to queue
+     * @param bytes Approximate size of the message
+     * @param completion Completion of an asynchronous publish (may be null)
+     * @return true if the message was queued
+     */
+    bool publish_partitioned(const std::shared_ptr<Topic>& topic, std::shared_ptr<Message> message,
+                             size_t bytes, std::shared_ptr<PublishCompletion> completion);
+    
+    /**
+     * @brief Approximate bytes held by queued, in-flight and retained messages
+     * @return Bytes in use
+     */
+    size_t memory_in_use() const;
+    
+    /**
+     * @brief Apply queue and memory limits before enqueuing (queue lock must be held)
+     * @param queue Queue the message is about to join
+     * @param bytes Approximate size of the message
+     * @param on_evict Called for each message evicted under OverflowPolicy::DropOldest
+     * @return true if the message may be enqueued
+     */
+    template<typename Queue, typename OnEvict>
+    bool make_room(Queue& queue, size_t bytes, OnEvict on_evict);
+    
+    /**
+     * @brief Evict retained messages to free memory for queued ones
+     * @param preferred_topic Topic evicted from first
+     * @param bytes Number of bytes to free
+     * @return Number of bytes freed
+     */
+    size_t reclaim_retained(std::string_view preferred_topic, size_t bytes);
+    
+    /**
+     * @brief Retain a processed message within the memory budget
+     * @param message Message to retain
+     * @param bytes Approximate size of the message
+     */
+    void retain_message(const std::shared_ptr<Message>& message, size_t bytes);
+    
+    /**
+     * @brief Immutable set of interceptors, replaced as a whole on change
+     */
+    struct InterceptorTable {
+        struct Scoped {
+            std::string id;
+            std::shared_ptr<TopicFilter> filter;
+            std::shared_ptr<MessageInterceptor> interceptor;
+        };
+        
+        std::vector<std::shared_ptr<MessageInterceptor>> global;
+        std::vector<Scoped> scoped;
+    };
+    
+    /**
+     * @brief Read-side epoch of one broker thread (0 while it holds no table)
+     */
+    struct alignas(64) InterceptorReader {
+        std::atomic<uint64_t> epoch{0};
+    };
+    
+    /**
+     * @brief Keeps the loaded interceptor table alive until it goes out of scope
+     */
+    class InterceptorGuard {
+    public:
+        InterceptorGuard() = default;
+        
+        InterceptorGuard(InterceptorReader* reader, const InterceptorTable* table)
+            : reader_(reader)
+            , table_(table) {
+        }
+        
+        ~InterceptorGuard() {
+            if (reader_) {
+                reader_->epoch.store(0, std::memory_order_release);
+            }
+        }
+        
+        InterceptorGuard(const InterceptorGuard&) = delete;
+        InterceptorGuard& operator=(const InterceptorGuard&) = delete;
+        
+        explicit operator bool() const {
+            return table_ != nullptr;
+        }
+        
+        const InterceptorTable& operator*() const {
+            return *table_;
+        }
+        
+    private:
+        InterceptorReader* reader_ = nullptr;
+        const InterceptorTable* table_ = nullptr;
+    };
+    
+    /**
+     * @brief Install a new interceptor table (interceptors_mutex_ must be held)
+     *
+     * The previous table is retired and freed once no reader can still hold
+     * it, which is checked again on every later call.
+     *
+     * @param table Table to publish to the workers (null entries are not allowed)
+     */
+    void store_interceptors(std::shared_ptr<const InterceptorTable> table);
+    
+    /**
+     * @brief Give the calling broker thread a read-side epoch for load_interceptors()
+     */
+    void register_interceptor_reader();
+    
+    /**
+     * @brief Run the interceptors applying to a message
+     * @param table Interceptor table loaded by the caller
+     * @param message Message about to be routed
+     * @param report Report of an asynchronous publish (may be null)
+     * @return false if the message was dropped
+     */
+    bool intercept(const InterceptorTable& table, Message& message, DeliveryReport* report);
+    
+    /**
+     * @brief Load the interceptor table if any interceptor is installed
+     *
+     * Only threads that called register_interceptor_reader() may call this.
+     *
+     * @return Guard holding the table, empty when there is nothing to run
+     */
+    InterceptorGuard load_interceptors() const;
+    
     /**
      * @brief Process a message
      * @param message Message to process
+     * @param bytes Approximate size of the message
+     * @param report Receives per-result delivery counts (may be null)
+     * @return Number of successful deliveries
+     */
+    size_t process_message(const std::shared_ptr<Message>& message, size_t bytes = 0,
+                           DeliveryReport* report = nullptr);
+    
+    /**
+     * @brief Claim a ring slot for a message and publish it
+     * @param topic Topic of the message
+     * @param message Message to publish
+     * @param bytes Approximate size of the message
+     * @param completion Completion of an asynchronous publish (may be null)
+     * @return true if the message was published to the ring
+     */
+    bool ring_publish(std::string_view topic, std::shared_ptr<Message> message, size_t bytes,
+                      std::shared_ptr<PublishCompletion> completion);
+    
+    /**
+     * @brief Ring routing stage: retain and match published slots in sequence order
+     */
+    void ring_router_thread();
+    
+    /**
+     * @brief Ring delivery stage: deliver the routed slots assigned to this worker
+     * @param index Worker index
+     */
+    void ring_delivery_thread(size_t index);
+    
+    /**
+     * @brief Wait until a ring condition holds, spinning before blocking
+     * @param ready Condition to wait for
+     * @param active Flag that keeps the caller waiting while set
+     * @return false if the flag was cleared and the condition does not hold
+     */
+    template<typename Ready>
+    bool ring_wait(Ready ready, const std::atomic<bool>& active);
+    
+    /**
+     * @brief Wake ring threads blocked in ring_wait()
+     */
+    void ring_wake();
+    
+    /**
+     * @brief Drop the unprocessed ring slots, finishing their completions as evicted
+     */
+    void clear_ring();
+    
+    /**
+     * @brief Drop the messages left in the shared queue, finishing their completions as evicted
+     */
+    void clear_queue();
+    
+    /**
+     * @brief Process messages taken from the shared queue together
+     * @param batch Messages in queue order
+     */
+    void process_batch(std::vector<QueuedMessage>& batch);
+    
+    /**
+     * @brief Collect the subscriptions a message is delivered to (subscriptions_mutex_ must be held)
+     * @param message Message to match
+     * @param matching Receives the subscriptions
+     * @param groups Receives the matching share groups instead of their selected member (optional)
+     */
+    void collect_matching(const Message& message, std::vector<std::shared_ptr<Subscription>>& matching,
+                          std::vector<std::shared_ptr<SubscriptionGroup>>* groups = nullptr);
+    
+    /**
+     * @brief Pick one member of each share group right before delivery
+     *
+     * Batched routing defers the choice so LeastLoaded sees the load left
+     * by the previous deliveries of the batch.
+     *
+     * @param message Message to deliver
+     * @param groups Share groups collected by collect_matching()
+     * @param matching Receives the selected members
+     */
+    void select_members(const Message& message, const std::vector<std::shared_ptr<SubscriptionGroup>>& groups,
+                        std::vector<std::shared_ptr<Subscription>>& matching);
+    
+    /**
+     * @brief Deliver a message to the given subscriptions
+     * @param message Message to deliver
+     * @param subscriptions Target subscriptions
+     * @param report Receives per-result delivery counts (may be null)
+     * @return Number of successful deliveries
      */
-    void process_message(std::shared_ptr<Message> message);
+    size_t deliver_to(const std::shared_ptr<Message>& message,
+                      const std::vector<std::shared_ptr<Subscription>>& subscriptions,
+                      DeliveryReport* report);
+    
+    /**
+     * @brief Adjust the adaptive batch size after a batch
+     * @param processed Number of messages in the batch
+     * @param elapsed_ns Time spent processing the batch
+     * @param remaining Queue depth left behind when the batch was taken
+     */
+    void adapt_batch_size(size_t processed, uint64_t elapsed_ns, size_t remaining);
     
     /**
      * @brief Find matching subscriptions for a topic
@@ -208,23 +1269,125 @@ private:
     
     // State
     std::atomic<bool> running_{false};
+    std::atomic<bool> accepting_{false};  // Cleared first on shutdown so staged messages can be flushed for good
     std::atomic<size_t> published_messages_{0};
     std::atomic<size_t> delivered_messages_{0};
+    std::atomic<size_t> duplicate_messages_{0};
+    
+    // Publish capture (null when not capturing)
+    std::atomic<bool> capturing_{false};
+    std::shared_ptr<PublishRecorder> recorder_;
+    
+    // Duplicate suppression (null when disabled)
+    std::unique_ptr<DuplicateFilter> dedup_filter_;
+    
+    // Writers serialize on the mutex; workers only load the raw pointer after
+    // announcing the current epoch. A table retired at epoch E is freed once
+    // no reader announces an epoch of E or less
+    std::mutex interceptors_mutex_;
+    std::atomic<const InterceptorTable*> active_interceptors_{nullptr};
+    std::atomic<uint64_t> interceptors_epoch_{1};
+    std::shared_ptr<const InterceptorTable> interceptors_;
+    std::vector<std::pair<uint64_t, std::shared_ptr<const InterceptorTable>>> retired_interceptors_;
+    std::deque<InterceptorReader> interceptor_readers_;
+    static thread_local InterceptorReader* interceptor_reader_;
+    std::atomic<size_t> intercepted_messages_{0};
+    
+    // Huge page arena backing the tables below (null = default heap)
+    HugePageArena* arena_ = nullptr;
     
     // Topics and subscriptions
     mutable std::mutex topics_mutex_;
-    std::unordered_map<std::string, std::shared_ptr<Topic>> topics_;
+    ArenaMap<std::shared_ptr<Topic>> topics_;
+    std::set<std::string_view> topic_names_;  // Sorted names of topics_, viewing Topic::name()
+    std::atomic<uint64_t> topics_generation_{1};  // Bumped when topics leave topics_
+    size_t gc_cursor_ = 0;
+    std::atomic<size_t> evicted_topics_{0};
+    
+    // Startup snapshot, its topics already materialized (an evicted topic must
+    // not come back with stale state) and the number of those not yet loaded
+    std::shared_ptr<Snapshot> snapshot_;
+    std::vector<bool> snapshot_loaded_;
+    size_t snapshot_pending_ = 0;
+    std::mutex snapshot_write_mutex_;
     
     mutable std::mutex subscriptions_mutex_;
-    std::unordered_map<std::string, std::shared_ptr<Subscription>> subscriptions_;
+    ArenaMap<std::shared_ptr<Subscription>> subscriptions_;
+    std::unordered_map<std::string, std::shared_ptr<SubscriptionGroup>> share_groups_;
+    // Exactly one routing index is kept: the automaton when enabled, else the table
+    std::unique_ptr<SubscriptionTable> subscription_table_;
+    std::unique_ptr<TopicAutomaton> automaton_;
     
     // Message queue
     mutable std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
-    std::queue<std::shared_ptr<Message>> message_queue_;
+    MessageQueue message_queue_;
+    
+    // Per-thread publish staging buffers (kept alive after their thread exits until flushed)
+    mutable std::mutex staging_mutex_;
+    std::vector<std::shared_ptr<StagingBuffer>> staging_buffers_;
+    std::atomic<size_t> staging_flushes_{0};
+    
+    /**
+     * @brief A ring slot; the targets vector keeps its capacity across reuse
+     */
+    struct RingSlot {
+        std::shared_ptr<Message> message;
+        size_t bytes = 0;
+        std::shared_ptr<PublishCompletion> completion;
+        std::vector<std::shared_ptr<Subscription>> targets;
+        std::vector<std::shared_ptr<SubscriptionGroup>> groups;
+    };
+    
+    // Ring dispatch engine: claim cursor in ring_, then routed, then one cursor per delivery worker
+    std::unique_ptr<RingBuffer<RingSlot>> ring_;
+    Sequence ring_routed_;
+    std::vector<std::unique_ptr<Sequence>> ring_delivered_;
+    std::mutex ring_mutex_;
+    std::condition_variable ring_cv_;
+    std::atomic<size_t> ring_waiters_{0};
+    std::atomic<bool> ring_routing_{false};  // Cleared by the router once it has drained the ring
+    std::atomic<size_t> ring_publishers_{0};  // Publishers that passed the running_ check and may still write a slot
+    
+    // Adaptive batching controller
+    std::atomic<size_t> batch_size_{1};
+    std::atomic<uint64_t> batch_cost_ns_{0};
+    std::atomic<size_t> batched_messages_{0};
+    
+    // Memory accounting
+    std::atomic<size_t> queued_bytes_{0};
+    std::atomic<size_t> in_flight_bytes_{0};
+    std::atomic<size_t> retained_bytes_{0};
+    std::atomic<size_t> dropped_messages_{0};
     
     // Worker threads
     std::vector<std::thread> workers_;
+    
+    // Ordered lanes for partitioned topics (started on first use)
+    mutable std::mutex lanes_mutex_;
+    std::vector<std::shared_ptr<PartitionLane>> lanes_;
+    std::atomic<size_t> partitioned_topic_count_{0};
+    
+    /**
+     * @brief A connected federation peer and the interest it advertised
+     */
+    struct FederationPeer {
+        std::shared_ptr<FederationLink> link;
+        std::unordered_map<std::string, std::shared_ptr<TopicFilter>> interest;
+    };
+    
+    // Federation; interest_mutex_ orders interest updates and is taken before federation_mutex_
+    mutable std::mutex interest_mutex_;
+    InterestSet local_interest_;
+    mutable std::mutex federation_mutex_;
+    std::unordered_map<std::string, FederationPeer> peers_;
+    std::atomic<size_t> peer_count_{0};
+    std::atomic<size_t> forwarded_messages_{0};
+    
+    // Housekeeping
+    std::mutex maintenance_mutex_;
+    std::condition_variable maintenance_cv_;
+    std::thread maintenance_;
 };
 
 } // namespace pubsub
@@ -0,0 +1,191 @@
+#ifndef CPP_PUBSUB_BUFFER_HPP
+#define CPP_PUBSUB_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pubsub {
+
+/**
+ * @brief Immutable, reference-counted byte buffer
+ *
+ * Copying a buffer or taking a slice only bumps a reference count; the bytes
+ * themselves are never copied. The underlying memory is released by its
+ * owner (a vector, a string or a custom deleter) once the last buffer or
+ * slice referring to it is destroyed.
+ */
+class Buffer {
+public:
+    /**
+     * @brief Deleter invoked with the original region once it is no longer referenced
+     */
+    using Deleter = std::function<void(const uint8_t* data, size_t size)>;
+
+    /**
+     * @brief Marker for "until the end of the buffer"
+     */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * @brief Construct an empty buffer
+     */
+    Buffer() = default;
+
+    /**
+     * @brief Create a buffer holding a copy of the given bytes
+     * @param data Pointer to the bytes
+     * @param size Number of bytes
+     * @return New buffer
+     */
+    static Buffer copy(const void* data, size_t size);
+
+    /**
+     * @brief Create a buffer that takes ownership of a vector without copying
+     * @param data Vector to adopt
+     * @return New buffer
+     */
+    static Buffer adopt(std::vector<uint8_t>&& data);
+
+    /**
+     * @brief Create a buffer that takes ownership of a string without copying
+     * @param data String to adopt
+     * @return New buffer
+     */
+    static Buffer adopt(std::string&& data);
+
+    /**
+     * @brief Create a buffer over externally owned memory (mmap regions, network buffers, ...)
+     * @param data Pointer to the bytes
+     * @param size Number of bytes
+     * @param deleter Called once when the last reference is released (may be empty)
+     * @return New buffer
+     */
+    static Buffer wrap(const void* data, size_t size, Deleter deleter);
+
+    /**
+     * @brief Get a pointer to the bytes
+     * @return Pointer to the first byte
+     */
+    const uint8_t* data() const { return data_; }
+
+    /**
+     * @brief Get the number of bytes
+     * @return Buffer size
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Check if the buffer is empty
+     * @return true if the buffer holds no bytes
+     */
+    bool empty() const { return size_ == 0; }
+
+    const uint8_t* begin() const { return data_; }
+    const uint8_t* end() const { return data_ + size_; }
+
+    uint8_t operator[](size_t index) const { return data_[index]; }
+
+    /**
+     * @brief Get a sub-range sharing the same underlying memory
+     * @param offset Offset of the first byte
+     * @param length Number of bytes (npos = until the end)
+     * @return Buffer referring to the sub-range
+     * @throws std::out_of_range if offset is past the end of the buffer
+     */
+    Buffer slice(size_t offset, size_t length = npos) const;
+
+    /**
+     * @brief View the bytes as characters
+     * @return String view over the buffer
+     */
+    std::string_view view() const;
+
+    /**
+     * @brief Copy the bytes into a vector
+     * @return Vector holding a copy of the bytes
+     */
+    std::vector<uint8_t> to_vector() const;
+
+    /**
+     * @brief Get the number of buffers sharing the underlying memory
+     * @return Reference count (0 for an empty buffer)
+     */
+    long use_count() const { return owner_.use_count(); }
+
+private:
+    Buffer(std::shared_ptr<const void> owner, const uint8_t* data, size_t size);
+
+    std::shared_ptr<const void> owner_;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Scatter-gather sequence of buffers
+ *
+ * Lets producers assemble a logical payload (e.g. header + body) from
+ * independent buffers without concatenating them.
+ */
+class BufferChain {
+public:
+    BufferChain() = default;
+
+    /**
+     * @brief Construct a chain from a list of buffers
+     * @param buffers Buffers in order
+     */
+    explicit BufferChain(std::vector<Buffer> buffers);
+
+    /**
+     * @brief Append a buffer to the chain (empty buffers are skipped)
+     * @param buffer Buffer to append
+     */
+    void append(Buffer buffer);
+
+    /**
+     * @brief Get the buffers in the chain
+     * @return Vector of buffers
+     */
+    const std::vector<Buffer>& buffers() const { return buffers_; }
+
+    /**
+     * @brief Get the total number of bytes across all buffers
+     * @return Total size
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Check if the chain holds no bytes
+     * @return true if the chain is empty
+     */
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * @brief Get the chain as one contiguous buffer
+     *
+     * A chain with a single buffer is returned without copying; otherwise the
+     * segments are gathered into a new buffer.
+     *
+     * @return Contiguous buffer
+     */
+    Buffer flatten() const;
+
+    /**
+     * @brief Copy all bytes into caller-provided memory
+     * @param out Destination with room for size() bytes
+     */
+    void copy_to(uint8_t* out) const;
+
+private:
+    std::vector<Buffer> buffers_;
+    size_t size_ = 0;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_BUFFER_HPP
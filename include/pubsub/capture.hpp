@@ -0,0 +1,198 @@
+#ifndef CPP_PUBSUB_CAPTURE_HPP
+#define CPP_PUBSUB_CAPTURE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pubsub/buffer.hpp"
+#include "pubsub/message.hpp"
+
+namespace pubsub {
+
+class Broker;
+
+/**
+ * @brief One captured publish call
+ */
+struct CaptureRecord {
+    /**
+     * @brief Time since the capture started
+     */
+    std::chrono::nanoseconds offset{0};
+
+    /**
+     * @brief Topic the message was published to
+     */
+    std::string topic;
+
+    /**
+     * @brief Message priority
+     */
+    Priority priority = Priority::Normal;
+
+    /**
+     * @brief Message headers
+     */
+    Message::Headers headers;
+
+    /**
+     * @brief Serialized payload
+     */
+    Buffer payload;
+};
+
+/**
+ * @brief Appends publish calls to a compact binary capture file
+ *
+ * Each record holds the offset from the start of the capture, the topic,
+ * priority, headers and the payload serialized with the given serializer.
+ * Recording is thread-safe; records are written in the order the calls are
+ * serialized by the recorder.
+ */
+class PublishRecorder {
+public:
+    /**
+     * @brief Constructor
+     * @param path Capture file to create
+     * @param serializer Payload serializer (null = only Buffer payloads are kept)
+     */
+    PublishRecorder(const std::string& path, std::shared_ptr<MessageSerializer> serializer);
+
+    /**
+     * @brief Destructor (flushes and closes the file)
+     */
+    ~PublishRecorder();
+
+    PublishRecorder(const PublishRecorder&) = delete;
+    PublishRecorder& operator=(const PublishRecorder&) = delete;
+
+    /**
+     * @brief Check if the capture file could be created
+     * @return true if the recorder is usable
+     */
+    bool is_open() const;
+
+    /**
+     * @brief Record a publish call
+     * @param topic Topic passed to publish
+     * @param message Published message
+     */
+    void record(std::string_view topic, const Message& message);
+
+    /**
+     * @brief Get the number of records written
+     * @return Record count
+     */
+    size_t record_count() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<MessageSerializer> serializer_;
+    Clock::time_point started_;
+    mutable std::mutex mutex_;
+    std::FILE* file_ = nullptr;
+    size_t record_count_ = 0;
+    std::vector<uint8_t> scratch_;
+};
+
+/**
+ * @brief Sequential reader for capture files
+ */
+class CaptureReader {
+public:
+    /**
+     * @brief Open a capture file
+     * @param path Capture file to read
+     */
+    explicit CaptureReader(const std::string& path);
+
+    /**
+     * @brief Destructor
+     */
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /**
+     * @brief Check if the file is a readable capture
+     * @return true if the reader is usable
+     */
+    bool is_open() const;
+
+    /**
+     * @brief Read the next record
+     * @param record Receives the record
+     * @return false at end of file or on a truncated record
+     */
+    bool next(CaptureRecord& record);
+
+private:
+    std::FILE* file_ = nullptr;
+    std::vector<uint8_t> scratch_;
+};
+
+/**
+ * @brief Options for replaying a capture
+ */
+struct ReplayOptions {
+    /**
+     * @brief Replay speed relative to the original timing (0 = as fast as possible)
+     */
+    double speed = 1.0;
+
+    /**
+     * @brief Serializer used to decode payloads on first access (null = publish payloads as Buffer)
+     */
+    std::shared_ptr<MessageSerializer> serializer;
+};
+
+/**
+ * @brief Result of a replay run
+ */
+struct ReplayStats {
+    /**
+     * @brief Number of records read from the capture
+     */
+    size_t records = 0;
+
+    /**
+     * @brief Number of messages accepted by publish
+     */
+    size_t published = 0;
+
+    /**
+     * @brief Number of messages rejected by publish
+     */
+    size_t dropped = 0;
+
+    /**
+     * @brief Wall time spent replaying
+     */
+    std::chrono::nanoseconds elapsed{0};
+
+    /**
+     * @brief Largest delay behind the scheduled publish time
+     */
+    std::chrono::nanoseconds max_lag{0};
+};
+
+/**
+ * @brief Re-publish a capture into a broker
+ * @param broker Target broker (must be running)
+ * @param reader Capture to replay
+ * @param options Replay options
+ * @return Replay statistics
+ */
+ReplayStats replay_capture(Broker& broker, CaptureReader& reader, const ReplayOptions& options = {});
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_CAPTURE_HPP
@@ -0,0 +1,81 @@
+#ifndef CPP_PUBSUB_CLOCK_HPP
+#define CPP_PUBSUB_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+
+namespace pubsub {
+
+/**
+ * @brief Cheap monotonic timestamps for per-message instrumentation
+ *
+ * On x86 CPUs with an invariant TSC, now() is a single RDTSC instruction;
+ * elsewhere it falls back to std::chrono::steady_clock. Ticks are
+ * calibrated against the steady clock (CLOCK_MONOTONIC) and anchored to
+ * the system clock (CLOCK_REALTIME), and are only converted when a
+ * duration or wall time is actually needed. The calibration refines itself
+ * as the process runs, so conversions become more accurate over time.
+ *
+ * Ticks are only meaningful within one process.
+ */
+class TickClock {
+public:
+    /**
+     * @brief Read the current tick count
+     * @return Ticks
+     */
+    static uint64_t now();
+    
+    /**
+     * @brief Check if ticks come from the TSC
+     * @return true if the invariant TSC is used
+     */
+    static bool uses_tsc();
+    
+    /**
+     * @brief Convert a tick difference to a duration
+     * @param ticks Tick difference (may be negative)
+     * @return Duration in nanoseconds
+     */
+    static std::chrono::nanoseconds to_duration(int64_t ticks);
+    
+    /**
+     * @brief Get the time elapsed between two tick readings
+     * @param start Earlier reading
+     * @param end Later reading
+     * @return Elapsed time
+     */
+    static std::chrono::nanoseconds elapsed(uint64_t start, uint64_t end) {
+        return to_duration(static_cast<int64_t>(end - start));
+    }
+    
+    /**
+     * @brief Convert a tick reading to a steady clock time point
+     * @param ticks Tick reading
+     * @return Steady clock time
+     */
+    static std::chrono::steady_clock::time_point to_steady(uint64_t ticks);
+    
+    /**
+     * @brief Convert a tick reading to wall time
+     * @param ticks Tick reading
+     * @return System clock time
+     */
+    static std::chrono::system_clock::time_point to_system(uint64_t ticks);
+    
+    /**
+     * @brief Convert wall time to a tick reading
+     * @param time System clock time
+     * @return Tick reading that converts back to the same wall time
+     */
+    static uint64_t from_system(std::chrono::system_clock::time_point time);
+    
+    /**
+     * @brief Re-measure the tick rate and the wall clock offset now
+     */
+    static void recalibrate();
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_CLOCK_HPP
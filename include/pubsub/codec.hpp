@@ -0,0 +1,304 @@
+#ifndef CPP_PUBSUB_CODEC_HPP
+#define CPP_PUBSUB_CODEC_HPP
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+#include "pubsub/buffer.hpp"
+#include "pubsub/message.hpp"
+
+namespace pubsub {
+
+namespace detail {
+
+/**
+ * @brief FNV-1a hash of the compiler's spelling of a type, computed at compile time
+ */
+template<typename T>
+constexpr uint64_t type_hash() {
+#if defined(_MSC_VER)
+    const char* name = __FUNCSIG__;
+#else
+    const char* name = __PRETTY_FUNCTION__;
+#endif
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name; ++name) {
+        hash ^= static_cast<unsigned char>(*name);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Check that no two types in a list share a wire tag
+ */
+template<typename... Ts>
+constexpr bool distinct_tags() {
+    constexpr uint64_t tags[] = {Ts::value...};
+    for (size_t i = 0; i < sizeof...(Ts); ++i) {
+        for (size_t j = i + 1; j < sizeof...(Ts); ++j) {
+            if (tags[i] == tags[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Wire tag identifying a payload type
+ *
+ * Defaults to a hash of the type name, which is stable for a given compiler.
+ * Specialize to pin the tag when producers and consumers are built with
+ * different compilers.
+ */
+template<typename T>
+struct TypeTag {
+    static constexpr uint64_t value = detail::type_hash<T>();
+};
+
+/**
+ * @brief Encoding of one payload type
+ *
+ * Trivially copyable types are encoded as their raw object bytes, so both
+ * ends must share the same layout. Other types are registered by
+ * specializing Codec with size(), encode() and decode() members.
+ */
+template<typename T, typename = void>
+struct Codec;
+
+template<typename T>
+struct Codec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    static size_t size(const T&) {
+        return sizeof(T);
+    }
+    
+    static void encode(const T& value, uint8_t* out) {
+        std::memcpy(out, &value, sizeof(T));
+    }
+    
+    static bool decode(const uint8_t* data, size_t size, T& out) {
+        if (size != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&out, data, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct Codec<std::string> {
+    static size_t size(const std::string& value) {
+        return value.size();
+    }
+    
+    static void encode(const std::string& value, uint8_t* out) {
+        std::memcpy(out, value.data(), value.size());
+    }
+    
+    static bool decode(const uint8_t* data, size_t size, std::string& out) {
+        out.assign(reinterpret_cast<const char*>(data), size);
+        return true;
+    }
+};
+
+template<>
+struct Codec<std::vector<uint8_t>> {
+    static size_t size(const std::vector<uint8_t>& value) {
+        return value.size();
+    }
+    
+    static void encode(const std::vector<uint8_t>& value, uint8_t* out) {
+        std::memcpy(out, value.data(), value.size());
+    }
+    
+    static bool decode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+        out.assign(data, data + size);
+        return true;
+    }
+};
+
+/**
+ * @brief Size of the type tag preceding every encoded payload
+ */
+constexpr size_t kTypeTagSize = sizeof(uint64_t);
+
+/**
+ * @brief Encode a payload as its type tag followed by its Codec encoding
+ * @tparam T Payload type
+ * @param value Payload
+ * @return Encoded payload
+ */
+template<typename T>
+std::vector<uint8_t> encode_payload(const T& value) {
+    const uint64_t tag = TypeTag<T>::value;
+    std::vector<uint8_t> out(kTypeTagSize + Codec<T>::size(value));
+    std::memcpy(out.data(), &tag, kTypeTagSize);
+    Codec<T>::encode(value, out.data() + kTypeTagSize);
+    return out;
+}
+
+/**
+ * @brief Read the type tag of an encoded payload
+ * @param data Encoded payload
+ * @param size Encoded size
+ * @param tag Receives the type tag
+ * @return false if the data is too short to hold a tag
+ */
+inline bool read_payload_tag(const uint8_t* data, size_t size, uint64_t& tag) {
+    if (size < kTypeTagSize) {
+        return false;
+    }
+    std::memcpy(&tag, data, kTypeTagSize);
+    return true;
+}
+
+/**
+ * @brief Decode a payload produced by encode_payload()
+ * @tparam T Expected payload type
+ * @param data Encoded payload
+ * @param out Receives the payload
+ * @return false if the tag does not match T or the body is malformed
+ */
+template<typename T>
+bool decode_payload(const Buffer& data, T& out) {
+    uint64_t tag = 0;
+    if (!read_payload_tag(data.data(), data.size(), tag) || tag != TypeTag<T>::value) {
+        return false;
+    }
+    return Codec<T>::decode(data.data() + kTypeTagSize, data.size() - kTypeTagSize, out);
+}
+
+/**
+ * @brief Serializer for a fixed set of payload types
+ *
+ * The registered types are known at compile time, so encoding looks the
+ * payload's type_info up once in a table sorted by type and decoding
+ * dispatches on the wire tag, without trying any_cast for each type.
+ * Payloads of other types fall back to MessageSerializer (Buffer payloads
+ * pass through, anything else serializes to nothing) and unknown tags
+ * decode to an empty std::any.
+ *
+ * Code that knows the payload type can call the static encode() and
+ * decode() directly, which skips the virtual call and the type lookup.
+ *
+ * @tparam Ts Registered payload types (each needs a Codec)
+ */
+template<typename... Ts>
+class TypedSerializer : public MessageSerializer {
+public:
+    static_assert(sizeof...(Ts) > 0, "TypedSerializer needs at least one payload type");
+    static_assert(detail::distinct_tags<TypeTag<Ts>...>(), "Payload types must have distinct type tags");
+    
+    /**
+     * @brief Encode a payload of a registered type without a virtual call
+     * @tparam T Payload type
+     * @param value Payload
+     * @return Encoded payload, readable by deserialize_buffer()
+     */
+    template<typename T>
+    static Buffer encode(const T& value) {
+        static_assert((std::is_same_v<T, Ts> || ...), "T is not registered with this TypedSerializer");
+        return Buffer::adopt(encode_payload(value));
+    }
+    
+    /**
+     * @brief Decode a payload of a registered type without a virtual call
+     * @tparam T Expected payload type
+     * @param data Encoded payload
+     * @param out Receives the payload
+     * @return false if the payload is not a T or is malformed
+     */
+    template<typename T>
+    static bool decode(const Buffer& data, T& out) {
+        static_assert((std::is_same_v<T, Ts> || ...), "T is not registered with this TypedSerializer");
+        return decode_payload(data, out);
+    }
+    
+    std::vector<uint8_t> serialize(const std::any& data) const override {
+        if (Encoder encode = find_encoder(data.type())) {
+            return encode(data);
+        }
+        return {};
+    }
+    
+    std::any deserialize(const std::vector<uint8_t>& data) const override {
+        return decode_any(data.data(), data.size());
+    }
+    
+    Buffer serialize_buffer(const std::any& data) const override {
+        if (Encoder encode = find_encoder(data.type())) {
+            return Buffer::adopt(encode(data));
+        }
+        return MessageSerializer::serialize_buffer(data);
+    }
+    
+    std::any deserialize_buffer(const Buffer& data) const override {
+        return decode_any(data.data(), data.size());
+    }
+    
+private:
+    using Encoder = std::vector<uint8_t> (*)(const std::any&);
+    
+    struct EncoderEntry {
+        std::type_index type;
+        Encoder encode;
+    };
+    
+    template<typename T>
+    static std::vector<uint8_t> encode_any(const std::any& data) {
+        return encode_payload(*std::any_cast<T>(&data));
+    }
+    
+    static Encoder find_encoder(const std::type_info& type) {
+        // type_index is not constexpr, so the table is sorted on first use
+        static const std::array<EncoderEntry, sizeof...(Ts)> encoders = [] {
+            std::array<EncoderEntry, sizeof...(Ts)> entries{{EncoderEntry{std::type_index(typeid(Ts)), &encode_any<Ts>}...}};
+            std::sort(entries.begin(), entries.end(), [](const EncoderEntry& a, const EncoderEntry& b) {
+                return a.type < b.type;
+            });
+            return entries;
+        }();
+        
+        std::type_index key(type);
+        auto it = std::lower_bound(encoders.begin(), encoders.end(), key,
+            [](const EncoderEntry& entry, const std::type_index& value) {
+                return entry.type < value;
+            });
+        return it != encoders.end() && it->type == key ? it->encode : nullptr;
+    }
+    
+    template<typename T>
+    static bool try_decode(uint64_t tag, const uint8_t* body, size_t size, std::any& out) {
+        if (tag != TypeTag<T>::value) {
+            return false;
+        }
+        T value{};
+        if (Codec<T>::decode(body, size, value)) {
+            out = std::move(value);
+        }
+        return true;
+    }
+    
+    static std::any decode_any(const uint8_t* data, size_t size) {
+        std::any out;
+        uint64_t tag = 0;
+        if (read_payload_tag(data, size, tag)) {
+            (void)(try_decode<Ts>(tag, data + kTypeTagSize, size - kTypeTagSize, out) || ...);
+        }
+        return out;
+    }
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_CODEC_HPP
@@ -0,0 +1,99 @@
+#ifndef CPP_PUBSUB_DEDUP_HPP
+#define CPP_PUBSUB_DEDUP_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace pubsub {
+
+/**
+ * @brief Bounded-window duplicate detector for message keys
+ *
+ * Keys are reduced to 64-bit fingerprints and stored in a fixed ring of
+ * open-addressing tables ("generations"). New keys go into the current
+ * generation; once it is full (or older than its share of the time window)
+ * the oldest generation is reused. Slots carry the epoch of the generation
+ * that wrote them, so reusing a generation only bumps its epoch instead of
+ * clearing the table. Memory is allocated once in the constructor and every
+ * check probes a fixed number of tables, so the cost per message is O(1)
+ * regardless of the publish rate.
+ */
+class DuplicateFilter {
+public:
+    /**
+     * @brief Constructor
+     * @param window_size Minimum number of most recent keys remembered
+     * @param window_ms Maximum age of remembered keys in milliseconds (0 = count bound only)
+     */
+    explicit DuplicateFilter(size_t window_size, uint64_t window_ms = 0);
+
+    /**
+     * @brief Record a key and report whether it was already seen
+     * @param key Deduplication key (message ID or header value)
+     * @param scope Optional scope mixed into the key (e.g. the topic name)
+     * @return true if the key is a duplicate within the window
+     */
+    bool check_and_insert(std::string_view key, std::string_view scope = {});
+
+    /**
+     * @brief Forget a key, e.g. after the message it admitted was rejected
+     *
+     * Lets a producer retry a publish that failed for reasons other than
+     * duplication without the retry being suppressed.
+     *
+     * @param key Deduplication key
+     * @param scope Scope passed to check_and_insert()
+     * @return true if the key was remembered
+     */
+    bool erase(std::string_view key, std::string_view scope = {});
+
+    /**
+     * @brief Forget all remembered keys
+     */
+    void clear();
+
+    /**
+     * @brief Get the approximate number of keys remembered
+     * @return Number of remembered keys
+     */
+    size_t size() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kGenerations = 4;
+
+    // A slot is live only while its epoch equals the generation's epoch
+    struct Generation {
+        std::vector<uint64_t> slots;
+        std::vector<uint32_t> epochs;
+        uint32_t epoch = 1;
+        size_t count = 0;
+        Clock::time_point started;
+    };
+
+    static uint64_t fingerprint(std::string_view key, std::string_view scope);
+
+    bool contains(const Generation& generation, uint64_t fp) const;
+    void insert(Generation& generation, uint64_t fp);
+    bool remove(Generation& generation, uint64_t fp);
+    void reset(Generation& generation, Clock::time_point now);
+    void rotate(Clock::time_point now);
+
+    size_t generation_limit_;
+    size_t mask_;
+    std::chrono::milliseconds generation_age_;
+    bool time_bounded_;
+
+    mutable std::mutex mutex_;
+    std::array<Generation, kGenerations> generations_;
+    size_t current_ = 0;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_DEDUP_HPP
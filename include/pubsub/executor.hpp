@@ -0,0 +1,148 @@
+#ifndef CPP_PUBSUB_EXECUTOR_HPP
+#define CPP_PUBSUB_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pubsub {
+
+/**
+ * @brief Runs subscription callbacks on a caller-chosen context
+ *
+ * Implementations must be thread-safe: execute() is called concurrently
+ * from the broker's worker threads.
+ */
+class Executor {
+public:
+    /**
+     * @brief Task type
+     */
+    using Task = std::function<void()>;
+    
+    virtual ~Executor() = default;
+    
+    /**
+     * @brief Run or schedule a task
+     * @param task Task to run
+     * @return false if the task was rejected and will never run
+     */
+    virtual bool execute(Task task) = 0;
+};
+
+/**
+ * @brief Runs tasks immediately on the calling thread
+ */
+class InlineExecutor : public Executor {
+public:
+    bool execute(Task task) override;
+};
+
+/**
+ * @brief Runs tasks on a dedicated pool of threads
+ */
+class ThreadPoolExecutor : public Executor {
+public:
+    /**
+     * @brief Constructor
+     * @param thread_count Number of threads (0 = hardware concurrency)
+     */
+    explicit ThreadPoolExecutor(size_t thread_count = 0);
+    
+    /**
+     * @brief Destructor (runs the remaining tasks, then joins the threads)
+     */
+    ~ThreadPoolExecutor() override;
+    
+    ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+    ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+    
+    /**
+     * @brief Queue a task for the pool
+     * @param task Task to run
+     * @return false once shutdown() has been called
+     */
+    bool execute(Task task) override;
+    
+    /**
+     * @brief Stop accepting tasks, run the queued ones and join the threads
+     */
+    void shutdown();
+    
+    /**
+     * @brief Get the number of threads in the pool
+     * @return Thread count
+     */
+    size_t thread_count() const;
+    
+private:
+    void worker_thread();
+    
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+/**
+ * @brief Queues tasks for a thread that runs its own event loop
+ *
+ * The owning thread either calls run() or drains the queue with
+ * run_pending() from its existing loop (for example a GUI idle handler).
+ * The optional wakeup function is called after each task is queued so the
+ * loop can be nudged, e.g. by posting an event to the GUI toolkit.
+ */
+class EventLoopExecutor : public Executor {
+public:
+    /**
+     * @brief Constructor
+     * @param wakeup Called after a task is queued (may be empty)
+     */
+    explicit EventLoopExecutor(std::function<void()> wakeup = {});
+    
+    /**
+     * @brief Queue a task for the loop
+     * @param task Task to run
+     * @return false once stop() has been called (until restart())
+     */
+    bool execute(Task task) override;
+    
+    /**
+     * @brief Run the tasks queued so far on the calling thread
+     * @return Number of tasks run
+     */
+    size_t run_pending();
+    
+    /**
+     * @brief Run tasks on the calling thread until stop() is called
+     *
+     * Returns once the tasks queued before stop() have run; returns after
+     * running them right away if stop() was called before run().
+     */
+    void run();
+    
+    /**
+     * @brief Stop accepting tasks and make run() return once the queue is empty
+     */
+    void stop();
+    
+    /**
+     * @brief Accept tasks again after stop(), so run() can be called again
+     */
+    void restart();
+    
+private:
+    std::function<void()> wakeup_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool stopped_ = false;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_EXECUTOR_HPP
@@ -0,0 +1,117 @@
+#ifndef CPP_PUBSUB_FEDERATION_HPP
+#define CPP_PUBSUB_FEDERATION_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace pubsub {
+
+class Message;
+
+/**
+ * @brief Incremental change to the set of patterns a broker is interested in
+ */
+struct InterestChange {
+    /**
+     * @brief Patterns that became part of the interest
+     */
+    std::vector<std::string> added;
+    
+    /**
+     * @brief Patterns that are no longer part of the interest
+     */
+    std::vector<std::string> removed;
+    
+    /**
+     * @brief Check if the change is a no-op
+     * @return true if nothing was added or removed
+     */
+    bool empty() const {
+        return added.empty() && removed.empty();
+    }
+};
+
+/**
+ * @brief Reference-counted set of subscription patterns reduced to a minimal cover
+ *
+ * Every subscribed pattern is counted, but only patterns not covered by a
+ * more general one are advertised: with "a/#" present, "a/b/+" adds nothing.
+ * add() and remove() return the change to the advertised cover so peers can
+ * be updated incrementally.
+ */
+class InterestSet {
+public:
+    /**
+     * @brief Check if one pattern matches every topic another pattern matches
+     *
+     * Only level-aligned wildcards ("+" as a whole level, "#" as the last
+     * level) take part in coverage; other patterns only cover themselves.
+     *
+     * @param general The broader pattern
+     * @param specific The pattern to test
+     * @return true if general covers specific
+     */
+    static bool covers(std::string_view general, std::string_view specific);
+    
+    /**
+     * @brief Count one more subscription to a pattern
+     * @param pattern Subscription pattern
+     * @return Change to the advertised cover
+     */
+    InterestChange add(const std::string& pattern);
+    
+    /**
+     * @brief Count one subscription to a pattern less
+     * @param pattern Subscription pattern
+     * @return Change to the advertised cover
+     */
+    InterestChange remove(const std::string& pattern);
+    
+    /**
+     * @brief Get the advertised cover
+     * @return Patterns not covered by any other pattern in the set
+     */
+    std::vector<std::string> patterns() const;
+    
+    /**
+     * @brief Remove every pattern
+     */
+    void clear();
+    
+private:
+    std::unordered_map<std::string, size_t> counts_;
+    std::unordered_set<std::string> cover_;
+};
+
+/**
+ * @brief Transport to one remote broker, implemented by the application
+ *
+ * Calls are made from broker threads and should not block; queue the data
+ * for a background sender if the transport can stall. send_interest() is
+ * called in the order the changes happen and must not subscribe or
+ * unsubscribe on the local broker.
+ */
+class FederationLink {
+public:
+    virtual ~FederationLink() = default;
+    
+    /**
+     * @brief Advertise a change of the local broker's interest to the peer
+     * @param change Added and removed patterns
+     */
+    virtual void send_interest(const InterestChange& change) = 0;
+    
+    /**
+     * @brief Forward a locally published message the peer is interested in
+     * @param message Message to forward
+     */
+    virtual void send_message(const std::shared_ptr<Message>& message) = 0;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_FEDERATION_HPP
@@ -0,0 +1,96 @@
+#ifndef CPP_PUBSUB_INTERCEPTOR_HPP
+#define CPP_PUBSUB_INTERCEPTOR_HPP
+
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace pubsub {
+
+class Message;
+
+/**
+ * @brief What happens to a message after an interceptor has seen it
+ */
+enum class InterceptResult {
+    /**
+     * @brief Pass the message on to the next interceptor and then to routing
+     */
+    Continue,
+    
+    /**
+     * @brief Drop the message; it is neither retained nor delivered
+     */
+    Drop
+};
+
+/**
+ * @brief Enriches, transforms, validates or drops messages before routing
+ *
+ * Interceptors run on a worker thread after the message is taken from the
+ * queue and before it is retained and matched against subscriptions. They
+ * may modify the message in place (headers, payload, priority), so a
+ * message object should not be published again while an earlier publish of
+ * it may still be intercepted. Implementations must be thread-safe: the
+ * same interceptor runs concurrently on several workers. An exception
+ * drops the message.
+ */
+class MessageInterceptor {
+public:
+    virtual ~MessageInterceptor() = default;
+    
+    /**
+     * @brief Inspect or modify a message
+     * @param message Message about to be routed
+     * @return Whether the message continues
+     */
+    virtual InterceptResult intercept(Message& message) = 0;
+};
+
+/**
+ * @brief Interceptor composed of stages known at compile time
+ *
+ * Each stage is a callable taking Message& and returning InterceptResult.
+ * The stages are stored by value and called in order without indirection,
+ * so a whole chain costs one virtual call; the first stage returning Drop
+ * ends the chain.
+ *
+ * @tparam Stages Stage types
+ */
+template<typename... Stages>
+class InterceptorChain : public MessageInterceptor {
+public:
+    /**
+     * @brief Constructor
+     * @param stages Stages, called in the given order
+     */
+    explicit InterceptorChain(Stages... stages)
+        : stages_(std::move(stages)...) {
+    }
+    
+    InterceptResult intercept(Message& message) override {
+        bool passed = std::apply([&message](auto&... stage) {
+            return ((stage(message) == InterceptResult::Continue) && ...);
+        }, stages_);
+        return passed ? InterceptResult::Continue : InterceptResult::Drop;
+    }
+    
+private:
+    std::tuple<Stages...> stages_;
+};
+
+/**
+ * @brief Compose stages into one interceptor
+ * @param stages Callables taking Message& and returning InterceptResult
+ * @return Interceptor running the stages in order
+ */
+template<typename... Stages>
+std::shared_ptr<MessageInterceptor> make_interceptor(Stages&&... stages) {
+    static_assert(sizeof...(Stages) > 0, "an interceptor needs at least one stage");
+    return std::make_shared<InterceptorChain<std::decay_t<Stages>...>>(std::forward<Stages>(stages)...);
+}
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_INTERCEPTOR_HPP
@@ -0,0 +1,248 @@
+#ifndef CPP_PUBSUB_MEMORY_HPP
+#define CPP_PUBSUB_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace pubsub {
+
+/**
+ * @brief How HugePageResource backs its mappings
+ */
+enum class HugePageMode {
+    /**
+     * @brief Normal pages only
+     */
+    Disabled,
+    
+    /**
+     * @brief Transparent huge pages requested with madvise(MADV_HUGEPAGE)
+     */
+    Transparent,
+    
+    /**
+     * @brief Explicit huge pages (MAP_HUGETLB), falling back to transparent ones
+     */
+    Explicit
+};
+
+/**
+ * @brief Memory resource mapping whole 2 MB huge pages
+ *
+ * Every allocation is rounded up to a multiple of the huge page size and
+ * mapped on its own, so this is meant as the upstream of a pool rather than
+ * for individual objects (see HugePageArena). When explicit huge pages are
+ * not available (none reserved in /proc/sys/vm/nr_hugepages) the mapping
+ * falls back to transparent huge pages, and where those are not supported
+ * to normal pages. Without mmap (Windows) the regions come from the default
+ * heap, aligned to the huge page size. Thread-safe.
+ */
+class HugePageResource : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Size of one huge page
+     */
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+    
+    /**
+     * @brief Constructor
+     * @param mode Preferred page type
+     */
+    explicit HugePageResource(HugePageMode mode = HugePageMode::Explicit);
+    
+    /**
+     * @brief Get the preferred page type
+     * @return Page mode
+     */
+    HugePageMode mode() const;
+    
+    /**
+     * @brief Get the number of bytes currently mapped
+     * @return Mapped bytes
+     */
+    size_t mapped_bytes() const;
+    
+    /**
+     * @brief Get the number of mapped bytes backed by explicit huge pages
+     * @return Bytes mapped with MAP_HUGETLB
+     */
+    size_t explicit_bytes() const;
+    
+    /**
+     * @brief Get the number of mapped bytes advised as transparent huge pages
+     * @return Bytes mapped with MADV_HUGEPAGE
+     */
+    size_t transparent_bytes() const;
+    
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    
+private:
+    HugePageMode mode_;
+    
+    // Page type of each live mapping, for the statistics
+    std::mutex regions_mutex_;
+    std::unordered_map<void*, bool> regions_;
+    
+    std::atomic<size_t> mapped_bytes_{0};
+    std::atomic<size_t> explicit_bytes_{0};
+    std::atomic<size_t> transparent_bytes_{0};
+};
+
+namespace detail {
+
+/**
+ * @brief Carves small blocks out of shared huge pages
+ *
+ * Blocks of half a huge page or more get their own mapping and are unmapped
+ * on release; smaller ones are cut from a common region and only returned
+ * when the carver is destroyed.
+ */
+class PageCarver : public std::pmr::memory_resource {
+public:
+    explicit PageCarver(HugePageResource& pages);
+    ~PageCarver() override;
+    
+    PageCarver(const PageCarver&) = delete;
+    PageCarver& operator=(const PageCarver&) = delete;
+    
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    
+private:
+    HugePageResource& pages_;
+    std::mutex mutex_;
+    std::vector<void*> regions_;
+    char* cursor_ = nullptr;
+    size_t remaining_ = 0;
+};
+
+} // namespace detail
+
+/**
+ * @brief Thread-safe pool allocating small objects out of huge pages
+ *
+ * A synchronized pool resource whose chunks are carved from huge pages.
+ * Memory is kept for reuse and only returned to the system when the arena
+ * is destroyed.
+ */
+class HugePageArena : public std::pmr::memory_resource {
+public:
+    /**
+     * @brief Constructor
+     * @param mode Preferred page type
+     */
+    explicit HugePageArena(HugePageMode mode = HugePageMode::Explicit);
+    
+    HugePageArena(const HugePageArena&) = delete;
+    HugePageArena& operator=(const HugePageArena&) = delete;
+    
+    /**
+     * @brief Get the underlying page resource (for statistics)
+     * @return Page resource
+     */
+    const HugePageResource& pages() const;
+    
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    
+private:
+    HugePageResource pages_;
+    detail::PageCarver carver_;
+    std::pmr::synchronized_pool_resource pool_;
+};
+
+/**
+ * @brief Allocator drawing from a memory resource that moves with its container
+ *
+ * Unlike std::pmr::polymorphic_allocator it propagates on assignment and
+ * swap, so a container can be moved onto a different resource by assigning
+ * a freshly constructed one.
+ *
+ * @tparam T Value type
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    
+    ArenaAllocator() noexcept
+        : resource_(std::pmr::new_delete_resource()) {
+    }
+    
+    ArenaAllocator(std::pmr::memory_resource* resource) noexcept
+        : resource_(resource ? resource : std::pmr::new_delete_resource()) {
+    }
+    
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : resource_(other.resource()) {
+    }
+    
+    T* allocate(size_t n) {
+        return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+    }
+    
+    void deallocate(T* p, size_t n) noexcept {
+        resource_->deallocate(p, n * sizeof(T), alignof(T));
+    }
+    
+    /**
+     * @brief Get the memory resource
+     * @return Memory resource
+     */
+    std::pmr::memory_resource* resource() const noexcept {
+        return resource_;
+    }
+    
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return resource_ == other.resource() || resource_->is_equal(*other.resource());
+    }
+    
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+    
+private:
+    std::pmr::memory_resource* resource_;
+};
+
+/**
+ * @brief Vector allocating through ArenaAllocator
+ */
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/**
+ * @brief String allocating through ArenaAllocator
+ */
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/**
+ * @brief Hash map allocating through ArenaAllocator
+ */
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+using ArenaHashMap = std::unordered_map<Key, Value, Hash, std::equal_to<Key>,
+                                        ArenaAllocator<std::pair<const Key, Value>>>;
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_MEMORY_HPP
@@ -2,7 +2,10 @@
 #define CPP_PUBSUB_MESSAGE_HPP
 
 #include <any>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -10,6 +13,9 @@
 #include <unordered_map>
 #include <vector>
 
+#include "pubsub/buffer.hpp"
+#include "pubsub/memory.hpp"
+
 namespace pubsub {
 
 /**
@@ -22,6 +28,58 @@ enum class Priority {
     Critical
 };
 
+namespace detail {
+
+template<typename T, typename = void>
+struct has_byte_size : std::false_type {};
+
+template<typename T>
+struct has_byte_size<T, std::void_t<decltype(std::declval<const T&>().byte_size())>> : std::true_type {};
+
+/**
+ * @brief Approximate number of bytes held by a payload
+ *
+ * Payload types can report their size through a byte_size() member; byte
+ * containers report their length and other types their object size.
+ */
+template<typename T>
+size_t payload_byte_size(const T& payload) {
+    if constexpr (has_byte_size<T>::value) {
+        return static_cast<size_t>(payload.byte_size());
+    } else if constexpr (std::is_same_v<T, Buffer> || std::is_same_v<T, BufferChain> ||
+                         std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>) {
+        return payload.size();
+    } else if constexpr (std::is_same_v<T, std::any>) {
+        return 0;
+    } else {
+        return sizeof(T);
+    }
+}
+
+struct EncodedPayload;
+
+/**
+ * @brief Wall time in nanoseconds, fixed once set (copyable, unlike std::atomic)
+ */
+struct CachedTimestamp {
+    static constexpr int64_t kUnset = std::numeric_limits<int64_t>::min();
+    
+    CachedTimestamp() = default;
+    
+    CachedTimestamp(const CachedTimestamp& other)
+        : ns(other.ns.load(std::memory_order_relaxed)) {
+    }
+    
+    CachedTimestamp& operator=(const CachedTimestamp& other) {
+        ns.store(other.ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+    
+    std::atomic<int64_t> ns{kUnset};
+};
+
+} // namespace detail
+
 /**
  * @brief Base class for message serialization
  */
@@ -42,6 +100,42 @@ public:
      * @return Deserialized message
      */
     virtual std::any deserialize(const std::vector<uint8_t>& data) const = 0;
+    
+    /**
+     * @brief Serialize data into a reference-counted buffer
+     *
+     * Buffer payloads are passed through without copying; a BufferChain of
+     * several segments has to be gathered into one buffer. Other payloads go
+     * through serialize() and the resulting vector is adopted by the buffer.
+     * Override to produce buffers directly.
+     *
+     * @param data The data to serialize
+     * @return Serialized data
+     */
+    virtual Buffer serialize_buffer(const std::any& data) const;
+    
+    /**
+     * @brief Serialize data into a sequence of buffers
+     *
+     * For writers that can emit scattered bytes. Buffer and BufferChain
+     * payloads are passed through segment by segment without copying; other
+     * payloads become a single segment from serialize_buffer().
+     *
+     * @param data The data to serialize
+     * @return Serialized data
+     */
+    virtual BufferChain serialize_chain(const std::any& data) const;
+    
+    /**
+     * @brief Deserialize data from a reference-counted buffer
+     *
+     * The default implementation copies the bytes and calls deserialize().
+     * Override to decode in place or to keep slices of the buffer.
+     *
+     * @param data The buffer to deserialize
+     * @return Deserialized data
+     */
+    virtual std::any deserialize_buffer(const Buffer& data) const;
 };
 
 /**
@@ -63,12 +157,29 @@ public:
     template<typename T>
     static std::shared_ptr<Message> create(std::string_view topic, T&& payload, 
                                           Priority priority = Priority::Normal) {
-        auto msg = std::make_shared<Message>(topic);
+        auto* resource = memory_resource();
+        auto msg = resource ? std::allocate_shared<Message>(ArenaAllocator<Message>(resource), topic)
+                            : std::make_shared<Message>(topic);
         msg->set_payload(std::forward<T>(payload));
         msg->set_priority(priority);
         return msg;
     }
     
+    /**
+     * @brief Set the memory resource that create() allocates messages from
+     *
+     * The resource must outlive every message allocated from it.
+     *
+     * @param resource Memory resource (null = default heap)
+     */
+    static void set_memory_resource(std::pmr::memory_resource* resource);
+    
+    /**
+     * @brief Get the memory resource that create() allocates messages from
+     * @return Memory resource, or null for the default heap
+     */
+    static std::pmr::memory_resource* memory_resource();
+    
     /**
      * @brief Constructor
      * @param topic Topic name
@@ -89,10 +200,25 @@ public:
     
     /**
      * @brief Get the message creation timestamp
+     *
+     * Converted from the creation tick count on first call and kept, so the
+     * value never changes once read, even as the TickClock calibration
+     * refines itself.
+     *
      * @return Creation timestamp
      */
     TimePoint timestamp() const;
     
+    /**
+     * @brief Get the creation timestamp as a raw TickClock reading
+     *
+     * Cheaper than timestamp() for measuring latency within the process:
+     * compare against TickClock::now() with TickClock::elapsed().
+     *
+     * @return Creation tick count
+     */
+    uint64_t timestamp_ticks() const;
+    
     /**
      * @brief Get the message priority
      * @return Message priority
@@ -139,9 +265,54 @@ public:
      */
     template<typename T>
     void set_payload(T&& payload) {
+        payload_size_ = detail::payload_byte_size<std::decay_t<T>>(payload);
         payload_ = std::forward<T>(payload);
+        encoded_.reset();
     }
     
+    /**
+     * @brief Set a serialized payload that is decoded on first typed access
+     *
+     * The bytes are decoded by the serializer the first time payload() or
+     * has_payload_type() is called; the result is cached and shared by
+     * copies of the message. Serializing the message again with the same
+     * serializer returns the original bytes.
+     *
+     * @param bytes Serialized payload
+     * @param serializer Serializer that produced the bytes
+     */
+    void set_encoded_payload(Buffer bytes, std::shared_ptr<const MessageSerializer> serializer);
+    
+    /**
+     * @brief Check if the payload is held in serialized form
+     * @return true if the payload was set with set_encoded_payload()
+     */
+    bool has_encoded_payload() const;
+    
+    /**
+     * @brief Get the serialized payload bytes
+     * @return Bytes passed to set_encoded_payload() (empty if none)
+     */
+    const Buffer& encoded_payload() const;
+    
+    /**
+     * @brief Get the approximate payload size in bytes
+     * @return Payload size reported by the payload, its serializer or set_payload_size()
+     */
+    size_t payload_size() const;
+    
+    /**
+     * @brief Override the approximate payload size used for memory accounting
+     * @param bytes Payload size in bytes
+     */
+    void set_payload_size(size_t bytes);
+    
+    /**
+     * @brief Get the approximate memory held by the message
+     * @return Bytes used by topic, ID, headers and payload
+     */
+    size_t approximate_size() const;
+    
     /**
      * @brief Get the message payload
      * @tparam T Expected type of the payload
@@ -150,7 +321,7 @@ public:
      */
     template<typename T>
     const T& payload() const {
-        return std::any_cast<const T&>(payload_);
+        return std::any_cast<const T&>(decoded_payload());
     }
     
     /**
@@ -160,7 +331,7 @@ public:
      */
     template<typename T>
     bool has_payload_type() const {
-        return payload_.type() == typeid(T);
+        return decoded_payload().type() == typeid(T);
     }
     
     /**
@@ -178,14 +349,71 @@ public:
      */
     static std::shared_ptr<Message> deserialize(const std::vector<uint8_t>& data, 
                                                const MessageSerializer& serializer);
-
+    
+    /**
+     * @brief Deserialize a message from binary data, decoding the payload on first access
+     * @param data The binary data
+     * @param serializer The serializer to use (kept by the message)
+     * @return Deserialized message
+     */
+    static std::shared_ptr<Message> deserialize(const std::vector<uint8_t>& data, 
+                                               std::shared_ptr<const MessageSerializer> serializer);
+    
+    /**
+     * @brief Serialize the payload into a buffer without intermediate copies
+     * @param serializer The serializer to use
+     * @return Serialized payload
+     */
+    Buffer serialize_buffer(const MessageSerializer& serializer) const;
+    
+    /**
+     * @brief Serialize the payload into a sequence of buffers without gathering them
+     * @param serializer The serializer to use
+     * @return Serialized payload
+     */
+    BufferChain serialize_chain(const MessageSerializer& serializer) const;
+    
+    /**
+     * @brief Deserialize a message from a buffer
+     * @param data The buffer
+     * @param serializer The serializer to use
+     * @return Deserialized message
+     */
+    static std::shared_ptr<Message> deserialize(const Buffer& data,
+                                               const MessageSerializer& serializer);
+    
+    /**
+     * @brief Deserialize a message from a buffer, decoding the payload on first access
+     *
+     * The buffer is shared as the encoded payload, and serializing the
+     * message again with the same serializer forwards it unchanged.
+     *
+     * @param data The buffer
+     * @param serializer The serializer to use (kept by the message)
+     * @return Deserialized message
+     */
+    static std::shared_ptr<Message> deserialize(const Buffer& data,
+                                               std::shared_ptr<const MessageSerializer> serializer);
+    
 private:
+    /**
+     * @brief Get the payload, decoding a serialized payload on first use
+     * @return Payload
+     */
+    const std::any& decoded_payload() const;
+    
+    // Restores identity, timestamp and headers of retained messages
+    friend class Snapshot;
+    
+    uint64_t timestamp_ticks_;
+    mutable detail::CachedTimestamp timestamp_ns_;
     std::string id_;
     std::string topic_;
-    TimePoint timestamp_;
     Priority priority_;
     Headers headers_;
     std::any payload_;
+    std::shared_ptr<detail::EncodedPayload> encoded_;
+    size_t payload_size_ = 0;
 };
 
 } // namespace pubsub
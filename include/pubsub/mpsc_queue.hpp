@@ -0,0 +1,84 @@
+#ifndef CPP_PUBSUB_MPSC_QUEUE_HPP
+#define CPP_PUBSUB_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+namespace pubsub {
+
+/**
+ * @brief Unbounded lock-free multi-producer single-consumer queue
+ *
+ * Producers link a node with a single atomic exchange and never wait for
+ * each other. try_pop() may only be called by one thread at a time; it can
+ * briefly report an empty queue while a producer is between its exchange
+ * and the store that links its node.
+ *
+ * Every push allocates one node, which the consumer frees when it pops the
+ * following element.
+ *
+ * @tparam T Element type (must be default constructible)
+ */
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        head_.store(stub, std::memory_order_relaxed);
+        tail_ = stub;
+    }
+    
+    ~MpscQueue() {
+        T value;
+        while (try_pop(value)) {
+        }
+        delete tail_;
+    }
+    
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    
+    /**
+     * @brief Append an element (any thread)
+     * @param value Element to append
+     */
+    void push(T value) {
+        Node* node = new Node();
+        node->value = std::move(value);
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Remove the oldest element (consumer thread only)
+     * @param out Receives the element
+     * @return false if no linked element is available
+     */
+    bool try_pop(T& out) {
+        Node* tail = tail_;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        
+        // The popped node becomes the new stub
+        out = std::move(next->value);
+        next->value = T();
+        tail_ = next;
+        delete tail;
+        return true;
+    }
+    
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+    
+    std::atomic<Node*> head_;
+    Node* tail_;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_MPSC_QUEUE_HPP
@@ -2,9 +2,24 @@
 #define CPP_PUBSUB_HPP
 
 #include "pubsub/broker.hpp"
+#include "pubsub/buffer.hpp"
+#include "pubsub/capture.hpp"
+#include "pubsub/clock.hpp"
+#include "pubsub/codec.hpp"
+#include "pubsub/dedup.hpp"
+#include "pubsub/executor.hpp"
+#include "pubsub/federation.hpp"
+#include "pubsub/interceptor.hpp"
+#include "pubsub/memory.hpp"
 #include "pubsub/message.hpp"
+#include "pubsub/mpsc_queue.hpp"
+#include "pubsub/ring_buffer.hpp"
+#include "pubsub/shared_group.hpp"
+#include "pubsub/snapshot.hpp"
 #include "pubsub/subscription.hpp"
+#include "pubsub/subscription_table.hpp"
 #include "pubsub/topic.hpp"
+#include "pubsub/topic_automaton.hpp"
 #include "pubsub/version.hpp"
 
 /**
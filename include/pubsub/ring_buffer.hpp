@@ -0,0 +1,228 @@
+#ifndef CPP_PUBSUB_RING_BUFFER_HPP
+#define CPP_PUBSUB_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace pubsub {
+
+/**
+ * @brief Monotonic sequence counter on its own cache line
+ *
+ * Sequences start at -1, meaning nothing has been claimed or processed.
+ */
+class alignas(64) Sequence {
+public:
+    explicit Sequence(int64_t initial = -1)
+        : value_(initial) {
+    }
+    
+    Sequence(const Sequence&) = delete;
+    Sequence& operator=(const Sequence&) = delete;
+    
+    int64_t get() const {
+        return value_.load(std::memory_order_acquire);
+    }
+    
+    void set(int64_t value) {
+        value_.store(value, std::memory_order_release);
+    }
+    
+private:
+    std::atomic<int64_t> value_;
+    char padding_[64 - sizeof(std::atomic<int64_t>)];
+};
+
+/**
+ * @brief Pre-allocated multi-producer ring of slots with sequence barriers
+ *
+ * Publishers claim a sequence, fill the slot at that sequence and publish
+ * it; consumers read published slots in sequence order and advance their
+ * own Sequence. A slot is reused once every gating sequence has moved past
+ * it, so a full ring either rejects (try_claim) or waits (claim). Claiming
+ * and publishing are lock-free and never allocate.
+ *
+ * @tparam T Slot type (default constructible; slots are reused, not destroyed)
+ */
+template<typename T>
+class RingBuffer {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Number of slots (rounded up to a power of two)
+     */
+    explicit RingBuffer(size_t capacity)
+        : capacity_(round_up(capacity))
+        , mask_(static_cast<int64_t>(capacity_) - 1)
+        , slots_(new T[capacity_])
+        , available_(new std::atomic<int64_t>[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            available_[i].store(-1, std::memory_order_relaxed);
+        }
+    }
+    
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+    
+    /**
+     * @brief Get the number of slots
+     * @return Capacity
+     */
+    size_t capacity() const {
+        return capacity_;
+    }
+    
+    /**
+     * @brief Set the consumer sequences that gate slot reuse (before any claim)
+     * @param gating Sequences of the last consumer stage
+     */
+    void set_gating(std::vector<const Sequence*> gating) {
+        gating_ = std::move(gating);
+    }
+    
+    /**
+     * @brief Get the slot of a sequence
+     * @param sequence Claimed or published sequence
+     * @return Slot
+     */
+    T& operator[](int64_t sequence) {
+        return slots_[sequence & mask_];
+    }
+    
+    /**
+     * @brief Claim the next sequence unless the ring is full
+     * @param sequence Receives the claimed sequence
+     * @return false if every slot is still in use
+     */
+    bool try_claim(int64_t& sequence) {
+        int64_t current = claimed_.get();
+        do {
+            if (current + 1 - static_cast<int64_t>(capacity_) > gate_.load(std::memory_order_acquire)) {
+                int64_t gate = minimum_gating();
+                gate_.store(gate, std::memory_order_release);
+                if (current + 1 - static_cast<int64_t>(capacity_) > gate) {
+                    return false;
+                }
+            }
+        } while (!claimed_cursor().compare_exchange_weak(current, current + 1, std::memory_order_acq_rel));
+        
+        sequence = current + 1;
+        return true;
+    }
+    
+    /**
+     * @brief Claim the next sequence, waiting for a free slot
+     * @param keep_waiting Called while waiting; returning false abandons the wait
+     * @param sequence Receives the claimed sequence
+     * @return false if the wait was abandoned (the sequence then stays claimed; it must not be
+     *         published, since its slot was never released by the consumers)
+     */
+    template<typename KeepWaiting>
+    bool claim(KeepWaiting keep_waiting, int64_t& sequence) {
+        sequence = claimed_cursor().fetch_add(1, std::memory_order_acq_rel) + 1;
+        
+        int64_t wrap = sequence - static_cast<int64_t>(capacity_);
+        while (wrap > gate_.load(std::memory_order_acquire)) {
+            int64_t gate = minimum_gating();
+            gate_.store(gate, std::memory_order_release);
+            if (wrap <= gate) {
+                break;
+            }
+            if (!keep_waiting()) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Make a filled slot visible to consumers
+     * @param sequence Claimed sequence
+     */
+    void publish(int64_t sequence) {
+        available_[sequence & mask_].store(sequence, std::memory_order_release);
+    }
+    
+    /**
+     * @brief Check if a sequence has been published
+     * @param sequence Sequence
+     * @return true if the slot holds that sequence
+     */
+    bool is_available(int64_t sequence) const {
+        return available_[sequence & mask_].load(std::memory_order_acquire) == sequence;
+    }
+    
+    /**
+     * @brief Find the end of the contiguous run of published sequences
+     * @param next First sequence to check
+     * @return Highest published sequence such that all from next on are published (next - 1 if none)
+     */
+    int64_t highest_available(int64_t next) const {
+        int64_t last = claimed_.get();
+        int64_t sequence = next;
+        while (sequence <= last && is_available(sequence)) {
+            ++sequence;
+        }
+        return sequence - 1;
+    }
+    
+    /**
+     * @brief Get the highest claimed sequence
+     * @return Claim cursor
+     */
+    int64_t claimed() const {
+        return claimed_.get();
+    }
+    
+    /**
+     * @brief Get the lowest gating sequence
+     * @return Minimum over the gating sequences (the claim cursor if there are none)
+     */
+    int64_t minimum_gating() const {
+        int64_t minimum = std::numeric_limits<int64_t>::max();
+        for (const Sequence* sequence : gating_) {
+            minimum = std::min(minimum, sequence->get());
+        }
+        return gating_.empty() ? claimed_.get() : minimum;
+    }
+    
+private:
+    static size_t round_up(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+    
+    // Sequence keeps its atomic private; the claim cursor needs CAS and fetch_add
+    struct alignas(64) ClaimCursor {
+        std::atomic<int64_t> value{-1};
+        
+        int64_t get() const {
+            return value.load(std::memory_order_acquire);
+        }
+    };
+    
+    std::atomic<int64_t>& claimed_cursor() {
+        return claimed_.value;
+    }
+    
+    const size_t capacity_;
+    const int64_t mask_;
+    std::unique_ptr<T[]> slots_;
+    std::unique_ptr<std::atomic<int64_t>[]> available_;
+    std::vector<const Sequence*> gating_;
+    ClaimCursor claimed_;
+    alignas(64) std::atomic<int64_t> gate_{-1};
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_RING_BUFFER_HPP
@@ -0,0 +1,125 @@
+#ifndef CPP_PUBSUB_SHARED_GROUP_HPP
+#define CPP_PUBSUB_SHARED_GROUP_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pubsub/subscription.hpp"
+
+namespace pubsub {
+
+class Message;
+class TopicFilter;
+
+/**
+ * @brief A shared subscription group ("$share/<group>/<filter>")
+ *
+ * All members share one topic filter, and each matching message is handed to
+ * exactly one member chosen by the group's ShareStrategy. The group is not
+ * synchronized itself; the broker guards it with its subscriptions mutex.
+ */
+class SubscriptionGroup {
+public:
+    /**
+     * @brief Prefix that marks a shared subscription pattern
+     */
+    static constexpr std::string_view kSharePrefix = "$share/";
+
+    /**
+     * @brief Constructor
+     * @param name Group name
+     * @param filter Topic filter shared by all members
+     * @param strategy Member selection strategy
+     * @param key_header Header hashed by ShareStrategy::KeyHash
+     */
+    SubscriptionGroup(
+        std::string name,
+        std::shared_ptr<TopicFilter> filter,
+        ShareStrategy strategy,
+        std::string key_header
+    );
+
+    /**
+     * @brief Check if a pattern denotes a shared subscription
+     * @param pattern Topic pattern
+     * @return true if the pattern starts with "$share/"
+     */
+    static bool is_shared_pattern(std::string_view pattern);
+
+    /**
+     * @brief Split a shared pattern into group name and topic filter
+     * @param pattern Pattern of the form "$share/<group>/<filter>"
+     * @param group Receives the group name
+     * @param filter Receives the topic filter pattern
+     * @return true if the pattern is well-formed
+     */
+    static bool parse(std::string_view pattern, std::string& group, std::string& filter);
+
+    /**
+     * @brief Build the key identifying a group within a broker
+     * @param group Group name
+     * @param filter Topic filter pattern
+     * @return Group key
+     */
+    static std::string make_key(std::string_view group, std::string_view filter);
+
+    /**
+     * @brief Get the group name
+     * @return Group name
+     */
+    const std::string& name() const;
+
+    /**
+     * @brief Check if a topic matches the group's filter
+     * @param topic Topic name
+     * @return true if the topic matches
+     */
+    bool matches(std::string_view topic) const;
+
+    /**
+     * @brief Add a member to the group
+     * @param subscription Member subscription
+     */
+    void add(std::shared_ptr<Subscription> subscription);
+
+    /**
+     * @brief Remove a member from the group
+     * @param subscription_id ID of the member to remove
+     * @return true if the member was removed
+     */
+    bool remove(const std::string& subscription_id);
+
+    /**
+     * @brief Get the number of members
+     * @return Member count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Check if the group has no members
+     * @return true if the group is empty
+     */
+    bool empty() const;
+
+    /**
+     * @brief Pick the member that should receive a message
+     * @param message Message to deliver
+     * @return Selected member, or nullptr if no member is active
+     */
+    std::shared_ptr<Subscription> select(const Message& message);
+
+private:
+    std::string name_;
+    std::shared_ptr<TopicFilter> filter_;
+    ShareStrategy strategy_;
+    std::string key_header_;
+    std::vector<std::shared_ptr<Subscription>> members_;
+    std::atomic<size_t> cursor_{0};
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_SHARED_GROUP_HPP
@@ -0,0 +1,190 @@
+#ifndef CPP_PUBSUB_SNAPSHOT_HPP
+#define CPP_PUBSUB_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pubsub {
+
+class Message;
+class MessageSerializer;
+
+/**
+ * @brief Read-only, memory-mapped snapshot of retained topic state
+ *
+ * File layout (native byte order):
+ *   header  : magic "PSNAP001", topic count, offset of the name table, offset of the index
+ *   records : per topic, its retained messages back to back
+ *   names   : topic names back to back
+ *   index   : one fixed-size entry per topic, sorted by name
+ *
+ * Opening a snapshot only maps the file; topics are located by binary search
+ * over the mapped index and decoded on demand, so startup cost does not grow
+ * with the number of topics.
+ */
+class Snapshot : public std::enable_shared_from_this<Snapshot> {
+public:
+    /**
+     * @brief Map a snapshot file
+     * @param path Path to the snapshot file
+     * @return Snapshot, or nullptr if the file is missing or invalid
+     */
+    static std::shared_ptr<Snapshot> open(const std::string& path);
+
+    /**
+     * @brief Destructor (unmaps the file)
+     */
+    ~Snapshot();
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /**
+     * @brief Get the number of topics in the snapshot
+     * @return Topic count
+     */
+    size_t topic_count() const;
+
+    /**
+     * @brief Get the name of a topic by index
+     * @param index Topic index (sorted by name)
+     * @return Topic name
+     */
+    std::string_view topic_name(size_t index) const;
+
+    /**
+     * @brief Look up a topic by name
+     * @param topic Topic name
+     * @param index Receives the topic index if found
+     * @return true if the topic is in the snapshot
+     */
+    bool find(std::string_view topic, size_t& index) const;
+
+    /**
+     * @brief Get the index of the first topic not ordered before a name
+     * @param topic Topic name (or prefix)
+     * @return Topic index, topic_count() if every topic is ordered before it
+     */
+    size_t lower_bound(std::string_view topic) const;
+
+    /**
+     * @brief Get the number of retained messages stored for a topic
+     * @param index Topic index
+     * @return Message count
+     */
+    size_t message_count(size_t index) const;
+
+    /**
+     * @brief Decode the retained messages of a topic
+     *
+     * Payloads are left encoded in buffers that point into the mapping and
+     * are decoded with the given serializer on first access. Without a
+     * serializer the payload is a Buffer over the stored bytes; the mapping
+     * stays alive as long as such buffers exist.
+     *
+     * @param index Topic index
+     * @param serializer Payload serializer (may be null)
+     * @return Messages, oldest first
+     */
+    std::vector<std::shared_ptr<Message>> load_messages(size_t index,
+                                                        const std::shared_ptr<const MessageSerializer>& serializer) const;
+
+private:
+    friend class SnapshotWriter;
+
+    struct IndexEntry {
+        uint64_t name_offset;
+        uint32_t name_length;
+        uint32_t message_count;
+        uint64_t data_offset;
+        uint64_t data_size;
+    };
+
+    Snapshot() = default;
+
+    IndexEntry entry(size_t index) const;
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    size_t topic_count_ = 0;
+    uint64_t index_offset_ = 0;
+    std::vector<uint8_t> fallback_;
+};
+
+/**
+ * @brief Streams topics and their retained messages into a snapshot file
+ *
+ * Records are written as topics are added; the sorted index is appended by
+ * finish(). The file is written under a temporary name and renamed into place,
+ * so readers never observe a partial snapshot.
+ */
+class SnapshotWriter {
+public:
+    /**
+     * @brief Constructor
+     * @param path Destination path
+     * @param serializer Payload serializer (null = only Buffer payloads are kept)
+     */
+    SnapshotWriter(std::string path, const MessageSerializer* serializer);
+
+    /**
+     * @brief Destructor (discards the file if finish() was not called)
+     */
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * @brief Check if the destination could be opened
+     * @return true if the writer is usable
+     */
+    bool is_open() const;
+
+    /**
+     * @brief Append a topic with its retained messages
+     * @param name Topic name
+     * @param messages Retained messages, oldest first
+     */
+    void add_topic(std::string_view name, const std::vector<std::shared_ptr<Message>>& messages);
+
+    /**
+     * @brief Copy a topic from an existing snapshot without decoding it
+     * @param snapshot Source snapshot
+     * @param index Topic index in the source snapshot
+     */
+    void add_topic(const Snapshot& snapshot, size_t index);
+
+    /**
+     * @brief Write the index and move the file into place
+     * @return true if the snapshot was written successfully
+     */
+    bool finish();
+
+private:
+    struct PendingEntry {
+        std::string name;
+        uint32_t message_count;
+        uint64_t data_offset;
+        uint64_t data_size;
+    };
+
+    void write(const void* data, size_t size);
+
+    std::string path_;
+    std::string temp_path_;
+    const MessageSerializer* serializer_;
+    std::FILE* file_ = nullptr;
+    uint64_t offset_ = 0;
+    bool failed_ = false;
+    std::vector<PendingEntry> entries_;
+    std::vector<uint8_t> record_;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_SNAPSHOT_HPP
@@ -7,11 +7,24 @@
 #include <string>
 #include <string_view>
 
+#include "pubsub/mpsc_queue.hpp"
+
 namespace pubsub {
 
+class Broker;
+class Executor;
 class Message;
 class TopicFilter;
 
+/**
+ * @brief How a shared subscription group picks the member that receives a message
+ */
+enum class ShareStrategy {
+    RoundRobin,
+    LeastLoaded,
+    KeyHash
+};
+
 /**
  * @brief Options for a subscription
  */
@@ -35,6 +48,35 @@ struct SubscriptionOptions {
      * @brief Maximum time to wait for a message in milliseconds (0 = no timeout)
      */
     uint64_t timeout_ms = 0;
+    
+    /**
+     * @brief Member selection strategy for shared ("$share/group/filter") subscriptions
+     *
+     * The strategy of the member that creates a group applies to the whole group.
+     */
+    ShareStrategy share_strategy = ShareStrategy::RoundRobin;
+    
+    /**
+     * @brief Header hashed by ShareStrategy::KeyHash (empty or missing = hash the topic)
+     */
+    std::string share_key_header;
+    
+    /**
+     * @brief Executor the callback runs on (null = the broker's worker thread)
+     *
+     * With an executor, deliver() hands the callback over and returns
+     * immediately; the message stays alive until the callback has run.
+     */
+    std::shared_ptr<Executor> executor;
+    
+    /**
+     * @brief Run the callback as a strand: never concurrently and in delivery order
+     *
+     * Deliveries are appended to a lock-free queue; the worker that finds
+     * the strand idle claims it and runs queued callbacks until it is empty
+     * (on the executor if one is set), so no worker waits for another.
+     */
+    bool strand = false;
 };
 
 /**
@@ -55,15 +97,29 @@ class Subscription : public std::enable_shared_from_this<Subscription> {
 public:
     /**
      * @brief Callback type for message delivery
+     *
+     * The message is passed by reference; a callback that keeps the message
+     * copies the pointer, so only such callbacks pay for reference counting.
+     */
+    using MessageCallback = std::function<void(const std::shared_ptr<Message>&)>;
+    
+    /**
+     * @brief Callback type for subscribers that only read the message during the call
      */
-    using MessageCallback = std::function<void(std::shared_ptr<Message>)>;
+    using MessageRefCallback = std::function<void(const Message&)>;
     
     /**
      * @brief Create a new subscription
+     *
+     * Patterns of the form "$share/<group>/<filter>" create a member of a
+     * shared subscription group; each matching message is delivered to only
+     * one member of the group.
+     *
      * @param topic_pattern Topic pattern to subscribe to
      * @param callback Callback function for message delivery
      * @param options Subscription options
      * @return Shared pointer to the new subscription
+     * @throws std::invalid_argument if a shared pattern is malformed
      */
     static std::shared_ptr<Subscription> create(
         std::string_view topic_pattern,
@@ -71,18 +127,50 @@ public:
         const SubscriptionOptions& options = {}
     );
     
+    /**
+     * @brief Create a new subscription whose callback receives the message by reference
+     * @param topic_pattern Topic pattern to subscribe to
+     * @param callback Callback function for message delivery
+     * @param options Subscription options
+     * @return Shared pointer to the new subscription
+     * @throws std::invalid_argument if a shared pattern is malformed
+     */
+    static std::shared_ptr<Subscription> create(
+        std::string_view topic_pattern,
+        MessageRefCallback callback,
+        const SubscriptionOptions& options = {}
+    );
+    
     /**
      * @brief Constructor
      * @param id Subscription ID
      * @param filter Topic filter
      * @param callback Callback function
      * @param options Subscription options
+     * @param share_group Shared subscription group name (empty = not shared)
      */
     Subscription(
         std::string id,
         std::shared_ptr<TopicFilter> filter,
         MessageCallback callback,
-        SubscriptionOptions options
+        SubscriptionOptions options,
+        std::string share_group = {}
+    );
+    
+    /**
+     * @brief Constructor
+     * @param id Subscription ID
+     * @param filter Topic filter
+     * @param callback Callback function receiving the message by reference
+     * @param options Subscription options
+     * @param share_group Shared subscription group name (empty = not shared)
+     */
+    Subscription(
+        std::string id,
+        std::shared_ptr<TopicFilter> filter,
+        MessageRefCallback callback,
+        SubscriptionOptions options,
+        std::string share_group = {}
     );
     
     /**
@@ -97,6 +185,24 @@ public:
      */
     const std::shared_ptr<TopicFilter>& filter() const;
     
+    /**
+     * @brief Get the subscription options
+     * @return Subscription options
+     */
+    const SubscriptionOptions& options() const;
+    
+    /**
+     * @brief Get the shared subscription group name
+     * @return Group name (empty if the subscription is not shared)
+     */
+    const std::string& share_group() const;
+    
+    /**
+     * @brief Check if this subscription is a member of a shared group
+     * @return true if the subscription is shared
+     */
+    bool is_shared() const;
+    
     /**
      * @brief Check if a topic matches this subscription's filter
      * @param topic Topic name
@@ -107,9 +213,10 @@ public:
     /**
      * @brief Deliver a message to this subscription
      * @param message Message to deliver
-     * @return Delivery result
+     * @return Delivery result (Filtered if the topic does not match; Rejected if
+     *         inactive, over the limit or refused by the executor)
      */
-    DeliveryResult deliver(std::shared_ptr<Message> message);
+    DeliveryResult deliver(const std::shared_ptr<Message>& message);
     
     /**
      * @brief Acknowledge a message
@@ -135,13 +242,58 @@ public:
      */
     size_t message_count() const;
     
+    /**
+     * @brief Get the number of deliveries currently executing the callback
+     * @return Number of in-flight deliveries
+     */
+    size_t in_flight() const;
+    
 private:
+    /**
+     * @brief Deliver a message already known to match the filter
+     * @param message Message to deliver
+     * @return Delivery result (Rejected if inactive, over the limit or refused by the executor)
+     */
+    DeliveryResult dispatch(const std::shared_ptr<Message>& message);
+    
+    // Routes through its indexes, which have already matched the topic
+    friend class Broker;
+    
+    /**
+     * @brief Run the callback and acknowledge the message
+     * @param message Message to deliver
+     * @return Success, or Error if the callback threw
+     */
+    DeliveryResult invoke(const std::shared_ptr<Message>& message);
+    
+    /**
+     * @brief Run queued strand deliveries until the queue is empty, then release the claim
+     */
+    void drain_strand();
+    
+    /**
+     * @brief Build a subscription from a pattern, generating its ID
+     */
+    template<typename Callback>
+    static std::shared_ptr<Subscription> create_with(
+        std::string_view topic_pattern,
+        Callback callback,
+        const SubscriptionOptions& options);
+    
     std::string id_;
     std::shared_ptr<TopicFilter> filter_;
     MessageCallback callback_;
+    MessageRefCallback ref_callback_;
     SubscriptionOptions options_;
+    std::string share_group_;
     std::atomic<size_t> message_count_{0};
+    std::atomic<size_t> in_flight_{0};
     std::atomic<bool> active_{true};
+    
+    // Strand: queued deliveries, the number of linked pushes and the claim flag of the draining thread
+    MpscQueue<std::shared_ptr<Message>> strand_queue_;
+    std::atomic<size_t> strand_pushed_{0};
+    std::atomic<bool> strand_claimed_{false};
 };
 
 } // namespace pubsub
@@ -0,0 +1,121 @@
+#ifndef CPP_PUBSUB_SUBSCRIPTION_TABLE_HPP
+#define CPP_PUBSUB_SUBSCRIPTION_TABLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pubsub/memory.hpp"
+
+namespace pubsub {
+
+class Subscription;
+class TopicFilter;
+
+/**
+ * @brief Contiguous table of subscriptions laid out for matching
+ *
+ * Exact subscriptions are found through an open-addressing hash from the
+ * topic's 64-bit hash to a topic entry. Entry fields are stored as parallel
+ * arrays, and each entry's subscribers occupy a contiguous run of one dense
+ * array. Matching an exact topic therefore reads one or two probe slots, the
+ * entry's fields and its run, without walking nodes or making virtual calls.
+ *
+ * All other subscriptions are grouped by filter (interned filters make
+ * identical patterns one group) and each group's filter is evaluated once
+ * per topic.
+ *
+ * Not thread-safe; callers serialize access.
+ */
+class SubscriptionTable {
+public:
+    /**
+     * @brief Constructor
+     * @param resource Memory resource backing the table (null = default heap)
+     */
+    explicit SubscriptionTable(std::pmr::memory_resource* resource = nullptr);
+    
+    SubscriptionTable(const SubscriptionTable&) = delete;
+    SubscriptionTable& operator=(const SubscriptionTable&) = delete;
+    
+    /**
+     * @brief Add a subscription under its filter
+     * @param subscription Subscription to add
+     */
+    void add(const std::shared_ptr<Subscription>& subscription);
+    
+    /**
+     * @brief Remove a subscription
+     * @param subscription Subscription to remove
+     * @return true if the subscription was present
+     */
+    bool remove(const std::shared_ptr<Subscription>& subscription);
+    
+    /**
+     * @brief Remove every subscription
+     */
+    void clear();
+    
+    /**
+     * @brief Append the subscriptions whose filter matches a topic
+     * @param topic Topic name
+     * @param matching Receives the matching subscriptions (in no particular order)
+     */
+    void match(std::string_view topic, std::vector<std::shared_ptr<Subscription>>& matching) const;
+    
+    /**
+     * @brief Get the number of subscriptions
+     * @return Subscription count
+     */
+    size_t size() const;
+    
+    /**
+     * @brief Get the number of distinct exact topics
+     * @return Exact topic count
+     */
+    size_t exact_topic_count() const;
+    
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+    
+    static uint64_t hash_topic(std::string_view topic);
+    
+    uint32_t find_slot(uint64_t hash, std::string_view topic) const;
+    void insert_slot(uint64_t hash, uint32_t entry);
+    void erase_slot(uint32_t slot);
+    void grow_slots();
+    
+    uint32_t create_entry(uint64_t hash, std::string_view topic);
+    void reserve_run(uint32_t entry, uint32_t capacity);
+    void compact_members();
+    
+    size_t size_ = 0;
+    
+    // Open-addressing slots (linear probing, hash 0 = empty)
+    ArenaVector<uint64_t> slot_hash_;
+    ArenaVector<uint32_t> slot_entry_;
+    size_t slot_count_ = 0;
+    
+    // Exact topic entries as parallel arrays
+    ArenaVector<ArenaString> entry_topic_;
+    ArenaVector<uint32_t> entry_offset_;
+    ArenaVector<uint32_t> entry_count_;
+    ArenaVector<uint32_t> entry_capacity_;
+    ArenaVector<uint32_t> free_entries_;
+    
+    // Subscriber runs of all entries; abandoned runs are reclaimed by compaction
+    ArenaVector<std::shared_ptr<Subscription>> members_;
+    size_t unused_members_ = 0;
+    
+    // Subscriptions matched through their filter, one group per filter
+    ArenaVector<std::shared_ptr<TopicFilter>> group_filter_;
+    ArenaVector<ArenaVector<std::shared_ptr<Subscription>>> group_members_;
+    ArenaHashMap<const TopicFilter*, uint32_t> group_index_;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_SUBSCRIPTION_TABLE_HPP
@@ -1,8 +1,13 @@
 #ifndef CPP_PUBSUB_TOPIC_HPP
 #define CPP_PUBSUB_TOPIC_HPP
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <regex>
 #include <string>
 #include <string_view>
@@ -27,6 +32,12 @@ public:
      * @return true if the topic matches
      */
     virtual bool matches(std::string_view topic) const = 0;
+    
+    /**
+     * @brief Get the pattern this filter was created from
+     * @return Pattern string (empty if the filter has no textual pattern)
+     */
+    virtual std::string_view pattern() const { return {}; }
 };
 
 /**
@@ -47,6 +58,12 @@ public:
      */
     bool matches(std::string_view topic) const override;
     
+    /**
+     * @brief Get the exact topic name
+     * @return Topic name
+     */
+    std::string_view pattern() const override;
+    
 private:
     std::string topic_;
 };
@@ -69,9 +86,24 @@ public:
      */
     bool matches(std::string_view topic) const override;
     
+    /**
+     * @brief Get the wildcard pattern
+     * @return Wildcard pattern
+     */
+    std::string_view pattern() const override;
+    
 private:
     std::string pattern_;
     std::regex regex_;
+    bool level_pattern_ = false;
+    
+    /**
+     * @brief Match a pattern level by level, without the regex
+     * @param pattern Pattern of literal, "+" and trailing "#" levels
+     * @param topic Topic name to check
+     * @return true if the topic matches the pattern
+     */
+    static bool matchLevels(std::string_view pattern, std::string_view topic);
     
     /**
      * @brief Convert MQTT-style wildcards to regex
@@ -81,6 +113,36 @@ private:
     static std::string wildcardToRegex(const std::string& pattern);
 };
 
+/**
+ * @brief Statistics about one partition of a partitioned topic
+ */
+struct PartitionStats {
+    /**
+     * @brief Partition index
+     */
+    size_t partition = 0;
+    
+    /**
+     * @brief Worker lane the partition is assigned to
+     */
+    size_t lane = 0;
+    
+    /**
+     * @brief Number of messages published to the partition
+     */
+    size_t published_messages = 0;
+    
+    /**
+     * @brief Number of deliveries made from the partition
+     */
+    size_t delivered_messages = 0;
+    
+    /**
+     * @brief Number of messages waiting to be processed
+     */
+    size_t queued_messages = 0;
+};
+
 /**
  * @brief A topic in the PubSub system
  */
@@ -124,9 +186,140 @@ public:
      */
     size_t subscription_count() const;
     
+    /**
+     * @brief Retain a message for late subscribers
+     * @param message Message to retain
+     * @param max_messages Maximum number of retained messages (0 = unlimited)
+     * @param bytes Approximate size of the message for memory accounting
+     * @return Net change in retained bytes (negative if older messages were evicted),
+     *         or nullopt if the topic was retired and must be looked up again
+     */
+    std::optional<int64_t> retain(std::shared_ptr<Message> message, size_t max_messages, size_t bytes = 0);
+    
+    /**
+     * @brief Evict the oldest retained messages
+     * @param bytes Number of bytes to free
+     * @return Number of bytes actually freed
+     */
+    size_t evict_retained(size_t bytes);
+    
+    /**
+     * @brief Get the retained messages, oldest first
+     * @return Vector of retained messages
+     */
+    std::vector<std::shared_ptr<Message>> retained_messages() const;
+    
+    /**
+     * @brief Get the number of retained messages
+     * @return Retained message count
+     */
+    size_t retained_count() const;
+    
+    /**
+     * @brief Get the approximate memory held by retained messages
+     * @return Retained bytes
+     */
+    size_t retained_bytes() const;
+    
+    /**
+     * @brief Drop all retained messages
+     * @return Number of bytes freed
+     */
+    size_t clear_retained_messages();
+    
+    /**
+     * @brief Record activity on the topic, postponing idle eviction
+     */
+    void touch();
+    
+    /**
+     * @brief Retire the topic if it holds no state and has been idle long enough
+     *
+     * A topic holding retained messages, subscriptions or partitions is never
+     * retired. Once retired, retain() refuses new messages so the owner can
+     * drop the topic without losing data stored concurrently.
+     *
+     * @param now Current time
+     * @param idle_timeout Minimum time since the last activity
+     * @param subscribed Optional check for subscribers tracked by the owner,
+     *                   called only when the topic is otherwise idle
+     * @return true if the topic was retired
+     */
+    bool retire_if_idle(std::chrono::steady_clock::time_point now, std::chrono::milliseconds idle_timeout,
+                        const std::function<bool()>& subscribed = nullptr);
+    
+    /**
+     * @brief Split the topic into partitions
+     *
+     * Must be called before messages are routed to the topic's partitions.
+     *
+     * @param count Number of partitions (0 = not partitioned)
+     */
+    void set_partition_count(size_t count);
+    
+    /**
+     * @brief Get the number of partitions
+     * @return Partition count (0 if the topic is not partitioned)
+     */
+    size_t partition_count() const;
+    
+    /**
+     * @brief Pick the partition for a message
+     *
+     * Messages carrying the key header are hashed so equal keys always land
+     * in the same partition; messages without a key are spread round-robin.
+     *
+     * @param message Message to place
+     * @param key_header Name of the partition key header
+     * @return Partition index
+     */
+    size_t select_partition(const Message& message, const std::string& key_header);
+    
+    /**
+     * @brief Record that a message was queued on a partition
+     * @param partition Partition index
+     */
+    void record_published(size_t partition);
+    
+    /**
+     * @brief Record that a message of a partition was processed
+     * @param partition Partition index
+     * @param delivered Number of successful deliveries
+     */
+    void record_processed(size_t partition, size_t delivered);
+    
+    /**
+     * @brief Get statistics for every partition
+     * @return Vector of partition statistics (lane is left as 0)
+     */
+    std::vector<PartitionStats> partition_stats() const;
+    
 private:
+    struct PartitionCounters {
+        std::atomic<size_t> published{0};
+        std::atomic<size_t> processed{0};
+        std::atomic<size_t> delivered{0};
+    };
+    
     std::string name_;
     std::unordered_map<std::string, std::shared_ptr<Subscription>> subscriptions_;
+    
+    struct RetainedMessage {
+        std::shared_ptr<Message> message;
+        size_t bytes;
+    };
+    
+    mutable std::mutex retained_mutex_;
+    std::deque<RetainedMessage> retained_;
+    size_t retained_bytes_ = 0;
+    bool retired_ = false;
+    
+    // Last activity as steady_clock ticks
+    std::atomic<std::chrono::steady_clock::rep> last_activity_;
+    
+    size_t partition_count_ = 0;
+    std::unique_ptr<PartitionCounters[]> partitions_;
+    std::atomic<size_t> next_partition_{0};
 };
 
 /**
@@ -136,6 +329,11 @@ class TopicFilterFactory {
 public:
     /**
      * @brief Create a topic filter from a pattern
+     *
+     * Filters are interned: while a filter for the pattern is alive, the
+     * same object is returned, so identical patterns share one compiled
+     * regex and can be evaluated once for all their subscriptions.
+     *
      * @param pattern Topic pattern (exact or with wildcards)
      * @return Shared pointer to a topic filter
      */
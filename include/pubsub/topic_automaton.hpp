@@ -0,0 +1,167 @@
+#ifndef CPP_PUBSUB_TOPIC_AUTOMATON_HPP
+#define CPP_PUBSUB_TOPIC_AUTOMATON_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pubsub/memory.hpp"
+
+namespace pubsub {
+
+class Subscription;
+
+/**
+ * @brief Matches a topic against every subscription pattern in one pass
+ *
+ * The patterns are kept in a trie over topic levels, where a level is a
+ * literal, "+" (any non-empty level) or a trailing "#" (the rest of the
+ * topic after the preceding "/"), giving the same results as
+ * WildcardTopicFilter. The trie is determinized lazily: each state of the
+ * automaton is the set of trie nodes reachable by the levels read so far,
+ * and its transitions are computed the first time a topic takes them and
+ * cached. Matching a topic then costs one hash lookup per level, however
+ * many patterns there are.
+ *
+ * Adding or removing a pattern updates the trie in place and discards the
+ * cached states, which are rebuilt on demand by the following matches. The
+ * cache is also restarted once it exceeds its state limit, bounding memory
+ * for pattern sets that determinize badly.
+ *
+ * Patterns the trie cannot express (wildcards inside a level, "#" other
+ * than as the last level, filters without a textual pattern) are checked
+ * one by one with Subscription::matches().
+ *
+ * Not thread-safe: match() updates the cache, so callers serialize all
+ * access.
+ */
+class TopicAutomaton {
+public:
+    /**
+     * @brief Constructor
+     * @param max_states Number of cached states, beyond one per trie node, above which the cache is restarted
+     * @param resource Memory resource backing the trie and the cache (null = default heap)
+     */
+    explicit TopicAutomaton(size_t max_states = 4096, std::pmr::memory_resource* resource = nullptr);
+    
+    TopicAutomaton(const TopicAutomaton&) = delete;
+    TopicAutomaton& operator=(const TopicAutomaton&) = delete;
+    
+    /**
+     * @brief Add a subscription under its filter's pattern
+     * @param subscription Subscription to add
+     */
+    void add(const std::shared_ptr<Subscription>& subscription);
+    
+    /**
+     * @brief Remove a subscription
+     * @param subscription Subscription to remove
+     * @return true if the subscription was present
+     */
+    bool remove(const std::shared_ptr<Subscription>& subscription);
+    
+    /**
+     * @brief Remove every subscription
+     */
+    void clear();
+    
+    /**
+     * @brief Append the subscriptions whose pattern matches a topic
+     * @param topic Topic name
+     * @param matching Receives the matching subscriptions (in no particular order)
+     */
+    void match(std::string_view topic, std::vector<std::shared_ptr<Subscription>>& matching);
+    
+    /**
+     * @brief Get the number of subscriptions
+     * @return Subscription count
+     */
+    size_t size() const;
+    
+    /**
+     * @brief Get the number of cached automaton states
+     * @return State count
+     */
+    size_t state_count() const;
+    
+    /**
+     * @brief Check if the trie can express a pattern
+     * @param pattern Topic pattern
+     * @return false if the pattern has to be matched on its own
+     */
+    static bool is_level_pattern(std::string_view pattern);
+    
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+    
+    using SubscriptionList = ArenaVector<std::shared_ptr<Subscription>>;
+    
+    // Trie node; literal children are keyed by interned label
+    struct Node {
+        explicit Node(std::pmr::memory_resource* resource)
+            : children(resource), terminal(resource), hash(resource) {
+        }
+        
+        uint32_t parent = kNone;
+        uint32_t label = kNone;
+        ArenaHashMap<uint32_t, uint32_t> children;
+        uint32_t plus = kNone;
+        SubscriptionList terminal;
+        SubscriptionList hash;
+    };
+    
+    // Cached automaton state; other covers non-empty levels that are no child's label
+    struct State {
+        explicit State(std::pmr::memory_resource* resource)
+            : nodes(resource), transitions(resource) {
+        }
+        
+        ArenaVector<uint32_t> nodes;
+        ArenaHashMap<uint32_t, uint32_t> transitions;
+        uint32_t other = kNone;
+        bool other_known = false;
+    };
+    
+    struct NodeSetHash {
+        size_t operator()(const ArenaVector<uint32_t>& nodes) const;
+    };
+    
+    uint32_t intern(std::string_view label);
+    void release(uint32_t label);
+    uint32_t find_label(std::string_view label) const;
+    
+    uint32_t allocate_node(uint32_t parent, uint32_t label);
+    void prune(uint32_t node);
+    
+    void reset_states();
+    uint32_t state_for(ArenaVector<uint32_t>& nodes);
+    uint32_t step(uint32_t state, std::string_view level);
+    
+    size_t max_states_;
+    std::pmr::memory_resource* resource_;
+    size_t size_ = 0;
+    
+    ArenaVector<Node> nodes_;
+    ArenaVector<uint32_t> free_nodes_;
+    
+    // Views in label_ids_ point into label_text_, whose elements never move
+    std::deque<ArenaString, ArenaAllocator<ArenaString>> label_text_;
+    ArenaVector<size_t> label_refs_;
+    ArenaVector<uint32_t> free_labels_;
+    ArenaHashMap<std::string_view, uint32_t> label_ids_;
+    
+    ArenaVector<State> states_;
+    ArenaHashMap<ArenaVector<uint32_t>, uint32_t, NodeSetHash> state_ids_;
+    ArenaVector<uint32_t> scratch_;
+    
+    // Subscriptions matched one by one
+    SubscriptionList individual_;
+};
+
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_TOPIC_AUTOMATON_HPP
@@ -0,0 +1,87 @@
+#ifndef CPP_PUBSUB_SRC_BINARY_CODEC_HPP
+#define CPP_PUBSUB_SRC_BINARY_CODEC_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pubsub {
+namespace detail {
+
+// Helpers for the native-endian binary formats used by snapshots and captures
+
+template<typename T>
+T read_value(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void append_value(std::vector<uint8_t>& out, T value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+inline void append_bytes(std::vector<uint8_t>& out, const void* data, size_t size) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+inline void append_string(std::vector<uint8_t>& out, std::string_view str) {
+    append_value<uint32_t>(out, static_cast<uint32_t>(str.size()));
+    append_bytes(out, str.data(), str.size());
+}
+
+// Bounds-checked cursor over an encoded record
+class RecordReader {
+public:
+    RecordReader(const uint8_t* data, size_t size)
+        : data_(data), size_(size) {
+    }
+
+    template<typename T>
+    bool read(T& value) {
+        if (size_ - pos_ < sizeof(T)) {
+            return false;
+        }
+        value = read_value<T>(data_ + pos_);
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool read_bytes(size_t length, const uint8_t*& out) {
+        if (size_ - pos_ < length) {
+            return false;
+        }
+        out = data_ + pos_;
+        pos_ += length;
+        return true;
+    }
+
+    bool read_string(std::string& out) {
+        uint32_t length = 0;
+        const uint8_t* bytes = nullptr;
+        if (!read(length) || !read_bytes(length, bytes)) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(bytes), length);
+        return true;
+    }
+
+    size_t position() const {
+        return pos_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+};
+
+} // namespace detail
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_SRC_BINARY_CODEC_HPP
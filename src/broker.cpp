@@ -1,15 +1,32 @@
 #include "pubsub/broker.hpp"
+#include "pubsub/capture.hpp"
+#include "pubsub/clock.hpp"
+#include "pubsub/dedup.hpp"
 #include "pubsub/message.hpp"
+#include "pubsub/shared_group.hpp"
+#include "pubsub/snapshot.hpp"
 #include "pubsub/subscription.hpp"
 #include "pubsub/topic.hpp"
+#include "pubsub/topic_automaton.hpp"
 #include <algorithm>
+#include <limits>
+#include <array>
+#include <chrono>
 #include <functional>
 #include <stdexcept>
 #include <thread>
 #include <list>
+#include <unordered_set>
 
 namespace pubsub {
 
+// Arenas are never freed: messages allocated from them may outlive the broker
+static HugePageArena& huge_page_arena(HugePageMode mode) {
+    static HugePageArena* transparent = new HugePageArena(HugePageMode::Transparent);
+    static HugePageArena* explicit_pages = new HugePageArena(HugePageMode::Explicit);
+    return mode == HugePageMode::Explicit ? *explicit_pages : *transparent;
+}
+
 // Custom deleter for Broker that can access protected destructor
 class BrokerDeleter {
 public:
@@ -20,6 +37,7 @@ public:
 
 // Initialize the singleton instance
 std::unique_ptr<Broker, BrokerDeleter> Broker::instance_;
+thread_local Broker::InterceptorReader* Broker::interceptor_reader_ = nullptr;
 
 Broker& Broker::instance() {
     if (!instance_) {
@@ -29,7 +47,8 @@ Broker& Broker::instance() {
 }
 
 Broker::Broker()
-    : running_(false) {
+    : running_(false)
+    , subscription_table_(std::make_unique<SubscriptionTable>()) {
 }
 
 Broker::~Broker() {
@@ -55,20 +74,149 @@ bool Broker::initialize(const BrokerConfig& config) {
         }
     }
     
+    // Set up duplicate suppression
+    if (config_.deduplicate_messages) {
+        dedup_filter_ = std::make_unique<DuplicateFilter>(
+            config_.dedup_window_size, config_.dedup_window_ms);
+    } else {
+        dedup_filter_.reset();
+    }
+    
+    // Configured interceptors replace the previous ones; topic-level ones are kept
+    {
+        std::lock_guard<std::mutex> interceptors_lock(interceptors_mutex_);
+        auto table = std::make_shared<InterceptorTable>();
+        if (interceptors_) {
+            table->scoped = interceptors_->scoped;
+        }
+        for (const auto& interceptor : config_.interceptors) {
+            if (interceptor) {
+                table->global.push_back(interceptor);
+            }
+        }
+        store_interceptors(std::move(table));
+    }
+    
+    // Move the queue, the routing tables and new messages onto the arena
+    HugePageArena* previous_arena = arena_;
+    arena_ = config_.huge_pages != HugePageMode::Disabled ? &huge_page_arena(config_.huge_pages) : nullptr;
+    clear_queue();
+    {
+        std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+        message_queue_ = MessageQueue(MessageQueue::container_type(ArenaAllocator<QueuedMessage>{arena_}));
+    }
+    {
+        decltype(topics_) topics(decltype(topics_)::allocator_type{arena_});
+        topics.insert(topics_.begin(), topics_.end());
+        topics_ = std::move(topics);
+        
+        std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+        decltype(subscriptions_) subscriptions(decltype(subscriptions_)::allocator_type{arena_});
+        subscriptions.insert(subscriptions_.begin(), subscriptions_.end());
+        subscriptions_ = std::move(subscriptions);
+        
+        // Rebuild the active routing index of the surviving subscriptions on the arena
+        subscription_table_.reset();
+        automaton_.reset();
+        if (config_.topic_automaton) {
+            automaton_ = std::make_unique<TopicAutomaton>(config_.topic_automaton_max_states, arena_);
+        } else {
+            subscription_table_ = std::make_unique<SubscriptionTable>(arena_);
+        }
+        for (auto& pair : subscriptions_) {
+            if (!pair.second->is_shared()) {
+                if (automaton_) {
+                    automaton_->add(pair.second);
+                } else {
+                    subscription_table_->add(pair.second);
+                }
+            }
+        }
+    }
+    if (arena_) {
+        Message::set_memory_resource(arena_);
+    } else if (previous_arena && Message::memory_resource() == previous_arena) {
+        Message::set_memory_resource(nullptr);
+    }
+    
+    // Map the startup snapshot; its topics are materialized on first use
+    snapshot_.reset();
+    snapshot_loaded_.clear();
+    snapshot_pending_ = 0;
+    if (!config_.snapshot_path.empty()) {
+        snapshot_ = Snapshot::open(config_.snapshot_path);
+        if (snapshot_) {
+            snapshot_loaded_.assign(snapshot_->topic_count(), false);
+            snapshot_pending_ = snapshot_->topic_count();
+        }
+    }
+    
     // Initialize worker threads
     running_ = true;
-    workers_.reserve(config_.thread_count);
+    accepting_ = true;
     
-    for (size_t i = 0; i < config_.thread_count; ++i) {
+    if (config_.dispatch_engine == DispatchEngine::Ring) {
+        ring_ = std::make_unique<RingBuffer<RingSlot>>(std::max<size_t>(config_.ring_capacity, 2));
+        ring_routed_.set(-1);
+        ring_delivered_.clear();
+        
+        std::vector<const Sequence*> gating;
+        for (size_t i = 0; i < config_.thread_count; ++i) {
+            ring_delivered_.push_back(std::make_unique<Sequence>());
+            gating.push_back(ring_delivered_.back().get());
+        }
+        ring_->set_gating(std::move(gating));
+        ring_routing_ = true;
+        
+        workers_.reserve(config_.thread_count + 1);
         workers_.emplace_back([this]() {
-            worker_thread();
+            ring_router_thread();
+        });
+        for (size_t i = 0; i < config_.thread_count; ++i) {
+            workers_.emplace_back([this, i]() {
+                ring_delivery_thread(i);
+            });
+        }
+    } else {
+        ring_.reset();
+        workers_.reserve(config_.thread_count);
+        
+        for (size_t i = 0; i < config_.thread_count; ++i) {
+            workers_.emplace_back([this]() {
+                worker_thread();
+            });
+        }
+    }
+    
+    bool periodic_snapshots = !config_.snapshot_path.empty() && config_.snapshot_interval_ms > 0;
+    bool aged_staging = config_.publish_staging_size > 0 && config_.publish_staging_us > 0;
+    if (periodic_snapshots || config_.topic_idle_timeout_ms > 0 || aged_staging) {
+        maintenance_ = std::thread([this]() {
+            maintenance_thread();
         });
     }
     
+    if (!config_.capture_path.empty()) {
+        start_capture(config_.capture_path, config_.capture_serializer);
+    }
+    
     return true;
 }
 
 void Broker::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        
+        if (!running_) {
+            return;
+        }
+    }
+    
+    // Stop new publishes first, so the staging buffers can be flushed for
+    // good while the workers are still running to deliver them
+    accepting_ = false;
+    flush_staging_buffers(false);
+    
     {
         std::lock_guard<std::mutex> lock(topics_mutex_);
         
@@ -79,10 +227,16 @@ void Broker::shutdown() {
         running_ = false;
     }
     
+    stop_capture();
+    
     // Notify all worker threads to exit
     queue_cv_.notify_all();
+    if (ring_) {
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        ring_cv_.notify_all();
+    }
     
-    // Wait for all worker threads to finish
+    // Workers drain what was queued before running_ was cleared, then exit
     for (auto& worker : workers_) {
         if (worker.joinable()) {
             worker.join();
@@ -91,13 +245,75 @@ void Broker::shutdown() {
     
     workers_.clear();
     
+    // Whatever a racing publisher slipped in after the drain is dropped
+    flush_staging_buffers(false);
+    if (ring_) {
+        // A publisher past the running_ check may still be filling its slot
+        while (ring_publishers_.load() > 0) {
+            std::this_thread::yield();
+        }
+        clear_ring();
+    }
+    clear_queue();
+    
+    stop_partition_lanes();
+    
+    // No broker thread can still be reading a replaced interceptor table
+    {
+        std::lock_guard<std::mutex> lock(interceptors_mutex_);
+        retired_interceptors_.clear();
+        interceptor_readers_.clear();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(maintenance_mutex_);
+    }
+    maintenance_cv_.notify_all();
+    if (maintenance_.joinable()) {
+        maintenance_.join();
+    }
+    
+    // Persist the final retained state for a fast restart
+    if (!config_.snapshot_path.empty()) {
+        save_snapshot();
+    }
+    
     // Clear all topics and subscriptions
     {
         std::lock_guard<std::mutex> lock(topics_mutex_);
         topics_.clear();
+        topic_names_.clear();
+        topics_generation_++;
+        retained_bytes_ = 0;
+        snapshot_.reset();
+        snapshot_loaded_.clear();
+        snapshot_pending_ = 0;
         
         std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
         subscriptions_.clear();
+        share_groups_.clear();
+        if (automaton_) {
+            automaton_->clear();
+        } else {
+            subscription_table_->clear();
+        }
+    }
+    
+    // Peers are told about the cleared interest before they are dropped
+    {
+        std::lock_guard<std::mutex> lock(interest_mutex_);
+        InterestChange change;
+        change.removed = local_interest_.patterns();
+        local_interest_.clear();
+        
+        std::lock_guard<std::mutex> peers_lock(federation_mutex_);
+        for (auto& pair : peers_) {
+            if (!change.empty()) {
+                pair.second.link->send_interest(change);
+            }
+        }
+        peers_.clear();
+        peer_count_ = 0;
     }
 }
 
@@ -106,10 +322,240 @@ bool Broker::is_running() const {
 }
 
 bool Broker::publish(std::string_view topic_str, std::shared_ptr<Message> message) {
+    if (config_.publish_staging_size > 0 && accepting_) {
+        return stage_message(topic_str, std::move(message));
+    }
+    return publish_message(topic_str, std::move(message), false);
+}
+
+bool Broker::publish_async(std::string_view topic_str, std::shared_ptr<Message> message,
+                           PublishCallback on_complete) {
+    auto completion = std::make_shared<PublishCompletion>();
+    completion->callback = std::move(on_complete);
+    
+    if (!publish_message(topic_str, std::move(message), false, completion)) {
+        finish_publish(*completion);
+        return false;
+    }
+    
+    return true;
+}
+
+std::future<DeliveryReport> Broker::publish_async(std::string_view topic_str, std::shared_ptr<Message> message) {
+    auto promise = std::make_shared<std::promise<DeliveryReport>>();
+    auto future = promise->get_future();
+    
+    publish_async(topic_str, std::move(message), [promise](const DeliveryReport& report) {
+        promise->set_value(report);
+    });
+    
+    return future;
+}
+
+size_t Broker::flush() {
+    StagingBuffer& buffer = local_staging_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    return flush_staging(buffer);
+}
+
+Broker::StagingBuffer& Broker::local_staging_buffer() {
+    static thread_local std::shared_ptr<StagingBuffer> buffer;
+    
+    if (!buffer) {
+        buffer = std::make_shared<StagingBuffer>();
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        staging_buffers_.push_back(buffer);
+    }
+    
+    return *buffer;
+}
+
+std::string_view Broker::StagedMessage::topic_name() const {
+    return own_topic ? std::string_view(topic) : std::string_view(message->topic());
+}
+
+bool Broker::stage_message(std::string_view topic_str, std::shared_ptr<Message> message) {
+    StagingBuffer& buffer = local_staging_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    
+    // Only the first message reads the clock; aging is left to the maintenance thread
+    if (buffer.messages.empty()) {
+        buffer.oldest_ticks = TickClock::now();
+    }
+    
+    StagedMessage staged;
+    if (topic_str != message->topic()) {
+        staged.topic = std::string(topic_str);
+        staged.own_topic = true;
+    }
+    staged.message = std::move(message);
+    buffer.messages.push_back(std::move(staged));
+    
+    if (buffer.messages.size() >= config_.publish_staging_size) {
+        flush_staging(buffer);
+    }
+    
+    return true;
+}
+
+size_t Broker::flush_staging(StagingBuffer& buffer) {
+    if (buffer.messages.empty()) {
+        return 0;
+    }
+    
+    std::vector<StagedMessage> staged;
+    staged.swap(buffer.messages);
+    staging_flushes_++;
+    
     if (!running_) {
+        dropped_messages_ += staged.size();
+        return staged.size();
+    }
+    
+    // Messages that still need the shared queue, in staging order
+    std::vector<QueuedMessage> batch;
+    std::vector<size_t> batch_index;
+    batch.reserve(staged.size());
+    batch_index.reserve(staged.size());
+    
+    for (size_t i = 0; i < staged.size(); ++i) {
+        std::shared_ptr<PublishCompletion> completion;
+        if (admit_message(staged[i].topic_name(), staged[i].message, false, completion)) {
+            continue;
+        }
+        
+        size_t bytes = staged[i].message->approximate_size();
+        batch.push_back(QueuedMessage{std::move(staged[i].message), bytes, nullptr});
+        batch_index.push_back(i);
+    }
+    
+    // Ring slots are claimed one by one; the claim itself is lock-free
+    if (ring_) {
+        for (size_t i = 0; i < batch.size(); ++i) {
+            std::string_view topic = staged[batch_index[i]].topic_name();
+            std::shared_ptr<Message> admitted = dedup_filter_ ? batch[i].message : nullptr;
+            if (!ring_publish(topic, std::move(batch[i].message), batch[i].bytes, nullptr) && admitted) {
+                forget_duplicate(topic, *admitted);
+            }
+        }
+        return staged.size();
+    }
+    
+    // One queue lock for the whole batch; a message that does not fit goes
+    // through the single-message path, which may reclaim retained memory
+    std::vector<std::shared_ptr<PublishCompletion>> evicted;
+    auto on_evict = [&evicted](QueuedMessage& oldest) {
+        if (oldest.completion) {
+            evicted.push_back(std::move(oldest.completion));
+        }
+    };
+    
+    size_t next = 0;
+    size_t queued = 0;
+    while (next < batch.size()) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            while (next < batch.size() && make_room(message_queue_, batch[next].bytes, on_evict)) {
+                queued_bytes_ += batch[next].bytes;
+                message_queue_.push(std::move(batch[next]));
+                ++next;
+                ++queued;
+            }
+        }
+        
+        if (next < batch.size()) {
+            QueuedMessage& item = batch[next];
+            std::string_view topic = staged[batch_index[next]].topic_name();
+            std::shared_ptr<Message> admitted = dedup_filter_ ? item.message : nullptr;
+            if (enqueue_message(topic, std::move(item.message), item.bytes, nullptr)) {
+                ++queued;
+            } else if (admitted) {
+                forget_duplicate(topic, *admitted);
+            }
+            ++next;
+        }
+    }
+    
+    for (auto& oldest : evicted) {
+        oldest->report.evicted = true;
+        finish_publish(*oldest);
+    }
+    
+    if (queued > 1) {
+        queue_cv_.notify_all();
+    } else if (queued == 1) {
+        queue_cv_.notify_one();
+    }
+    
+    return staged.size();
+}
+
+void Broker::flush_staging_buffers(bool aged_only) {
+    std::vector<std::shared_ptr<StagingBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        buffers = staging_buffers_;
+    }
+    
+    const auto max_age = std::chrono::microseconds(config_.publish_staging_us);
+    const uint64_t now = TickClock::now();
+    
+    for (auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (!aged_only || TickClock::elapsed(buffer->oldest_ticks, now) >= max_age) {
+            flush_staging(*buffer);
+        }
+    }
+    
+    // Buffers of exited threads are only referenced here; drop them once empty
+    std::lock_guard<std::mutex> lock(staging_mutex_);
+    buffers.clear();
+    staging_buffers_.erase(std::remove_if(staging_buffers_.begin(), staging_buffers_.end(),
+                                          [](const std::shared_ptr<StagingBuffer>& buffer) {
+                                              if (buffer.use_count() > 1) {
+                                                  return false;
+                                              }
+                                              std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+                                              return buffer->messages.empty();
+                                          }),
+                           staging_buffers_.end());
+}
+
+void Broker::finish_publish(PublishCompletion& completion) {
+    try {
+        completion.callback(completion.report);
+    } catch (...) {
+        // A failing completion must not take down the worker
+    }
+}
+
+bool Broker::publish_from_peer(std::string_view topic_str, std::shared_ptr<Message> message) {
+    return publish_message(topic_str, std::move(message), true);
+}
+
+bool Broker::publish_message(std::string_view topic_str, std::shared_ptr<Message> message, bool from_peer,
+                             std::shared_ptr<PublishCompletion> completion) {
+    if (!accepting_) {
         return false;
     }
     
+    if (auto handled = admit_message(topic_str, message, from_peer, completion)) {
+        return *handled;
+    }
+    
+    const size_t bytes = message->approximate_size();
+    std::shared_ptr<Message> admitted = dedup_filter_ ? message : nullptr;
+    if (!enqueue_message(topic_str, std::move(message), bytes, std::move(completion))) {
+        if (admitted) {
+            forget_duplicate(topic_str, *admitted);
+        }
+        return false;
+    }
+    return true;
+}
+
+std::optional<bool> Broker::admit_message(std::string_view topic_str, std::shared_ptr<Message>& message,
+                                          bool from_peer, std::shared_ptr<PublishCompletion>& completion) {
     // Ensure the message has the correct topic
     if (message->topic() != topic_str) {
         // If the topic doesn't match, we could either update it or return an error
@@ -117,27 +563,124 @@ bool Broker::publish(std::string_view topic_str, std::shared_ptr<Message> messag
         // std::cerr << "Warning: Message topic doesn't match provided topic" << std::endl;
     }
     
+    // Record the call as issued so replays include duplicates and drops
+    if (capturing_.load(std::memory_order_relaxed)) {
+        if (auto recorder = std::atomic_load(&recorder_)) {
+            recorder->record(topic_str, *message);
+        }
+    }
+    
+    // Drop republished duplicates before they reach the queue
+    if (dedup_filter_) {
+        std::string header_value;
+        std::string_view key = dedup_key(*message, header_value);
+        std::string_view scope = config_.dedup_per_topic ? topic_str : std::string_view{};
+        if (dedup_filter_->check_and_insert(key, scope)) {
+            duplicate_messages_++;
+            if (completion) {
+                completion->report.accepted = true;
+                finish_publish(*completion);
+            }
+            return true;
+        }
+    }
+    
     // Increment published messages count
     published_messages_++;
     
-    // Add message to queue for processing by worker threads
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
+    // Remote demand does not depend on local queue limits. Interceptors
+    // modify the message in place on a worker, so peers then get a copy
+    if (!from_peer && peer_count_.load(std::memory_order_acquire) > 0) {
+        if (active_interceptors_.load(std::memory_order_acquire)) {
+            forward_to_peers(topic_str, std::make_shared<Message>(*message));
+        } else {
+            forward_to_peers(topic_str, message);
+        }
+    }
+    
+    // Partitioned topics bypass the shared queue for their ordered lane
+    if (partitioned_topic_count_.load(std::memory_order_acquire) > 0) {
+        std::shared_ptr<Topic> topic;
+        {
+            std::lock_guard<std::mutex> lock(topics_mutex_);
+            auto it = topics_.find(std::string(topic_str));
+            if (it != topics_.end() && it->second->partition_count() > 0) {
+                topic = it->second;
+            }
+        }
         
-        // Check if queue is full
-        if (config_.max_queue_size > 0 && message_queue_.size() >= config_.max_queue_size) {
-            // Handle based on priority
-            if (message->priority() <= Priority::Normal) {
-                // Drop normal or low priority messages when queue is full
-                return false;
-            } else {
-                // For high priority messages, we can't easily remove a low priority message
-                // from a std::queue, so we'll just drop the new message
+        if (topic) {
+            const size_t bytes = message->approximate_size();
+            std::shared_ptr<Message> admitted = dedup_filter_ ? message : nullptr;
+            if (!publish_partitioned(topic, std::move(message), bytes, std::move(completion))) {
+                if (admitted) {
+                    forget_duplicate(topic_str, *admitted);
+                }
                 return false;
             }
+            return true;
+        }
+    }
+    
+    return std::nullopt;
+}
+
+std::string_view Broker::dedup_key(const Message& message, std::string& storage) const {
+    if (config_.dedup_header.empty()) {
+        return message.id();
+    }
+    storage = message.get_header(config_.dedup_header, message.id());
+    return storage;
+}
+
+void Broker::forget_duplicate(std::string_view topic_str, const Message& message) {
+    std::string header_value;
+    std::string_view key = dedup_key(message, header_value);
+    dedup_filter_->erase(key, config_.dedup_per_topic ? topic_str : std::string_view{});
+}
+
+bool Broker::enqueue_message(std::string_view topic_str, std::shared_ptr<Message> message, size_t bytes,
+                             std::shared_ptr<PublishCompletion> completion) {
+    if (ring_) {
+        return ring_publish(topic_str, std::move(message), bytes, std::move(completion));
+    }
+    
+    // Completions of evicted messages run after the queue lock is released
+    std::vector<std::shared_ptr<PublishCompletion>> evicted;
+    auto on_evict = [&evicted](QueuedMessage& oldest) {
+        if (oldest.completion) {
+            evicted.push_back(std::move(oldest.completion));
+        }
+    };
+    
+    // Add message to queue for processing by worker threads
+    auto try_enqueue = [this, &message, &completion, &on_evict, bytes]() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        
+        // Check queue and memory limits
+        if (!make_room(message_queue_, bytes, on_evict)) {
+            return false;
         }
         
-        message_queue_.push(message);
+        if (completion) {
+            completion->report.accepted = true;
+        }
+        message_queue_.push(QueuedMessage{std::move(message), bytes, std::move(completion)});
+        queued_bytes_ += bytes;
+        return true;
+    };
+    
+    // Retained messages yield to queued ones when the memory budget is exhausted
+    bool queued = try_enqueue() || (reclaim_retained(topic_str, bytes) > 0 && try_enqueue());
+    
+    for (auto& oldest : evicted) {
+        oldest->report.evicted = true;
+        finish_publish(*oldest);
+    }
+    
+    if (!queued) {
+        dropped_messages_++;
+        return false;
     }
     
     // Notify one worker thread to process the message
@@ -148,92 +691,544 @@ bool Broker::publish(std::string_view topic_str, std::shared_ptr<Message> messag
 
 std::shared_ptr<Subscription> Broker::subscribe(
     std::string_view topic_pattern,
-    std::function<void(std::shared_ptr<Message>)> callback,
+    Subscription::MessageCallback callback,
+    const SubscriptionOptions& options) {
+    
+    if (!running_) {
+        throw std::runtime_error("Broker is not running");
+    }
+    
+    return add_subscription(Subscription::create(topic_pattern, std::move(callback), options));
+}
+
+std::shared_ptr<Subscription> Broker::subscribe(
+    std::string_view topic_pattern,
+    Subscription::MessageRefCallback callback,
     const SubscriptionOptions& options) {
     
     if (!running_) {
         throw std::runtime_error("Broker is not running");
     }
     
-    // Create a new subscription
-    auto subscription = Subscription::create(topic_pattern, callback, options);
+    return add_subscription(Subscription::create(topic_pattern, std::move(callback), options));
+}
+
+std::shared_ptr<Subscription> Broker::add_subscription(std::shared_ptr<Subscription> subscription) {
+    const auto& options = subscription->options();
     
     // Store the subscription
     {
         std::lock_guard<std::mutex> lock(subscriptions_mutex_);
         subscriptions_[subscription->id()] = subscription;
+        
+        // Shared members are routed through their group
+        if (!subscription->is_shared()) {
+            if (automaton_) {
+                automaton_->add(subscription);
+            } else {
+                subscription_table_->add(subscription);
+            }
+        } else {
+            std::string key = SubscriptionGroup::make_key(
+                subscription->share_group(), subscription->filter()->pattern());
+            
+            auto& group = share_groups_[key];
+            if (!group) {
+                group = std::make_shared<SubscriptionGroup>(
+                    subscription->share_group(),
+                    subscription->filter(),
+                    options.share_strategy,
+                    options.share_key_header);
+            }
+            group->add(subscription);
+        }
+    }
+    
+    update_local_interest(std::string(subscription->filter()->pattern()), true);
+    
+    // Replay retained messages to subscribers that asked for them
+    if (options.receive_existing_messages && config_.retain_messages && !subscription->is_shared()) {
+        deliver_retained(subscription);
     }
     
     return subscription;
 }
 
-bool Broker::unsubscribe(std::shared_ptr<Subscription> subscription) {
-    if (!subscription) {
+bool Broker::create_partitioned_topic(std::string_view topic_name, size_t partitions) {
+    if (!running_ || partitions == 0) {
         return false;
     }
     
-    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    start_partition_lanes();
     
-    auto it = subscriptions_.find(subscription->id());
-    if (it == subscriptions_.end()) {
-        return false;
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    // A snapshot topic is materialized first, so it is never loaded over this one
+    std::string name(topic_name);
+    auto it = topics_.find(name);
+    std::shared_ptr<Topic> topic = it != topics_.end() ? it->second : materialize_snapshot_topic(name);
+    if (!topic) {
+        topic = std::make_shared<Topic>(name);
+        topics_[name] = topic;
+        topic_names_.insert(topic->name());
     }
     
-    // Cancel the subscription
-    subscription->cancel();
+    if (topic->partition_count() > 0) {
+        return topic->partition_count() == partitions;
+    }
     
-    // Remove the subscription
-    subscriptions_.erase(it);
+    topic->set_partition_count(partitions);
+    partitioned_topic_count_.fetch_add(1, std::memory_order_release);
     
     return true;
 }
 
-BrokerStats Broker::get_stats() const {
-    BrokerStats stats;
-    
+std::vector<PartitionStats> Broker::get_partition_stats(std::string_view topic_name) const {
+    std::shared_ptr<Topic> topic;
     {
         std::lock_guard<std::mutex> lock(topics_mutex_);
-        stats.topic_count = topics_.size();
+        auto it = topics_.find(std::string(topic_name));
+        if (it == topics_.end()) {
+            return {};
+        }
+        topic = it->second;
     }
     
-    {
-        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-        stats.subscription_count = subscriptions_.size();
-    }
+    auto stats = topic->partition_stats();
     
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        stats.queued_messages = message_queue_.size();
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    for (auto& partition : stats) {
+        partition.lane = lanes_.empty() ? 0 : partition.partition % lanes_.size();
     }
     
-    stats.published_messages = published_messages_.load();
-    stats.delivered_messages = delivered_messages_.load();
-    stats.worker_threads = workers_.size();
-    
     return stats;
 }
 
-std::vector<std::string> Broker::get_topics() const {
-    std::vector<std::string> result;
-    
-    std::lock_guard<std::mutex> lock(topics_mutex_);
-    result.reserve(topics_.size());
-    
-    for (const auto& pair : topics_) {
-        result.push_back(pair.first);
+bool Broker::unsubscribe(std::shared_ptr<Subscription> subscription) {
+    if (!subscription) {
+        return false;
     }
     
-    return result;
-}
-
-void Broker::clear_retained_messages() {
-    std::lock_guard<std::mutex> lock(topics_mutex_);
-    
-    // This is a placeholder - we would need to implement clear_retained_messages in Topic
-    // for (auto& pair : topics_) {
-    //     pair.second->clear_retained_messages();
-    // }
-}
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        
+        auto it = subscriptions_.find(subscription->id());
+        if (it == subscriptions_.end()) {
+            return false;
+        }
+        
+        // Cancel the subscription
+        subscription->cancel();
+        
+        // Remove the subscription
+        subscriptions_.erase(it);
+        if (!subscription->is_shared()) {
+            if (automaton_) {
+                automaton_->remove(subscription);
+            } else {
+                subscription_table_->remove(subscription);
+            }
+        }
+        
+        if (subscription->is_shared()) {
+            auto group_it = share_groups_.find(SubscriptionGroup::make_key(
+                subscription->share_group(), subscription->filter()->pattern()));
+            if (group_it != share_groups_.end()) {
+                group_it->second->remove(subscription->id());
+                if (group_it->second->empty()) {
+                    share_groups_.erase(group_it);
+                }
+            }
+        }
+    }
+    
+    update_local_interest(std::string(subscription->filter()->pattern()), false);
+    
+    return true;
+}
+
+bool Broker::start_capture(const std::string& path, std::shared_ptr<MessageSerializer> serializer) {
+    auto recorder = std::make_shared<PublishRecorder>(path, std::move(serializer));
+    if (!recorder->is_open()) {
+        return false;
+    }
+    
+    std::atomic_store(&recorder_, std::move(recorder));
+    capturing_.store(true, std::memory_order_release);
+    
+    return true;
+}
+
+void Broker::stop_capture() {
+    capturing_.store(false, std::memory_order_release);
+    std::atomic_store(&recorder_, std::shared_ptr<PublishRecorder>());
+}
+
+BrokerStats Broker::get_stats() const {
+    BrokerStats stats;
+    
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        stats.topic_count = topics_.size() + snapshot_pending_;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        stats.subscription_count = subscriptions_.size();
+        stats.shared_group_count = share_groups_.size();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stats.queued_messages = message_queue_.size();
+    }
+    
+    if (ring_) {
+        stats.queued_messages += static_cast<size_t>(ring_->claimed() - ring_->minimum_gating());
+    }
+    
+    {
+        std::lock_guard<std::mutex> lanes_lock(lanes_mutex_);
+        for (const auto& lane : lanes_) {
+            std::lock_guard<std::mutex> lock(lane->mutex);
+            stats.queued_messages += lane->queue.size();
+        }
+        stats.partition_lanes = lanes_.size();
+    }
+    
+    stats.queued_bytes = queued_bytes_.load();
+    stats.in_flight_bytes = in_flight_bytes_.load();
+    stats.retained_bytes = retained_bytes_.load();
+    stats.dropped_messages = dropped_messages_.load();
+    stats.published_messages = published_messages_.load();
+    stats.delivered_messages = delivered_messages_.load();
+    stats.duplicate_messages = duplicate_messages_.load();
+    stats.intercepted_messages = intercepted_messages_.load();
+    stats.evicted_topics = evicted_topics_.load();
+    stats.forwarded_messages = forwarded_messages_.load();
+    stats.federation_peers = peer_count_.load();
+    stats.worker_threads = workers_.size();
+    stats.batch_size = batch_size_.load();
+    stats.batch_message_cost_ns = batch_cost_ns_.load();
+    stats.batched_messages = batched_messages_.load();
+    stats.staging_flushes = staging_flushes_.load();
+    {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        for (const auto& buffer : staging_buffers_) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            stats.staged_messages += buffer->messages.size();
+        }
+    }
+    if (arena_) {
+        stats.arena_mapped_bytes = arena_->pages().mapped_bytes();
+        stats.arena_huge_page_bytes = arena_->pages().explicit_bytes() + arena_->pages().transparent_bytes();
+    }
+    
+    return stats;
+}
+
+std::vector<std::string> Broker::get_topics() const {
+    std::vector<std::string> result;
+    
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    result.reserve(topics_.size() + snapshot_pending_);
+    
+    for (const auto& pair : topics_) {
+        result.push_back(pair.first);
+    }
+    
+    // Include snapshot topics that have not been materialized yet
+    if (snapshot_ && snapshot_pending_ > 0) {
+        for (size_t i = 0; i < snapshot_->topic_count(); ++i) {
+            if (!snapshot_loaded_[i]) {
+                result.emplace_back(snapshot_->topic_name(i));
+            }
+        }
+    }
+    
+    return result;
+}
+
+void Broker::clear_retained_messages() {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    for (auto& pair : topics_) {
+        retained_bytes_ -= pair.second->clear_retained_messages();
+    }
+    
+    // Retained state of the startup snapshot is dropped as well
+    snapshot_.reset();
+    snapshot_loaded_.clear();
+    snapshot_pending_ = 0;
+}
+
+std::vector<std::shared_ptr<Message>> Broker::get_retained_messages(std::string_view topic_name) {
+    std::shared_ptr<Topic> topic;
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        
+        std::string name(topic_name);
+        auto it = topics_.find(name);
+        topic = it != topics_.end() ? it->second : materialize_snapshot_topic(name);
+    }
+    
+    if (!topic) {
+        return {};
+    }
+    
+    return topic->retained_messages();
+}
+
+bool Broker::save_snapshot(const std::string& path) {
+    const std::string& target = path.empty() ? config_.snapshot_path : path;
+    if (target.empty()) {
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> write_lock(snapshot_write_mutex_);
+    
+    // Copy the registry so writing does not block publishers
+    std::vector<std::shared_ptr<Topic>> topics;
+    std::shared_ptr<Snapshot> previous;
+    std::vector<bool> previous_loaded;
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        topics.reserve(topics_.size());
+        for (const auto& pair : topics_) {
+            topics.push_back(pair.second);
+        }
+        previous = snapshot_;
+        previous_loaded = snapshot_loaded_;
+    }
+    
+    SnapshotWriter writer(target, config_.snapshot_serializer.get());
+    if (!writer.is_open()) {
+        return false;
+    }
+    
+    std::unordered_set<std::string_view> written;
+    written.reserve(topics.size());
+    for (const auto& topic : topics) {
+        writer.add_topic(topic->name(), topic->retained_messages());
+        written.insert(topic->name());
+    }
+    
+    // Materialized records are live topics now, or were evicted: neither is copied
+    if (previous) {
+        for (size_t i = 0; i < previous->topic_count(); ++i) {
+            if (!previous_loaded[i] && written.find(previous->topic_name(i)) == written.end()) {
+                writer.add_topic(*previous, i);
+            }
+        }
+    }
+    
+    return writer.finish();
+}
+
+std::string Broker::add_federation_peer(std::shared_ptr<FederationLink> link) {
+    static std::atomic<uint64_t> next_id{0};
+    std::string id = "peer_" + std::to_string(next_id++);
+    
+    // Hold the interest lock so no change slips between the initial state and updates
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    
+    InterestChange initial;
+    initial.added = local_interest_.patterns();
+    if (!initial.empty()) {
+        link->send_interest(initial);
+    }
+    
+    std::lock_guard<std::mutex> peers_lock(federation_mutex_);
+    peers_[id] = FederationPeer{std::move(link), {}};
+    peer_count_ = peers_.size();
+    
+    return id;
+}
+
+bool Broker::remove_federation_peer(const std::string& peer_id) {
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    std::lock_guard<std::mutex> peers_lock(federation_mutex_);
+    
+    if (peers_.erase(peer_id) == 0) {
+        return false;
+    }
+    peer_count_ = peers_.size();
+    
+    return true;
+}
+
+std::string Broker::add_interceptor(std::string_view topic_pattern, std::shared_ptr<MessageInterceptor> interceptor) {
+    if (!interceptor) {
+        return {};
+    }
+    
+    static std::atomic<uint64_t> next_id{0};
+    std::string id = "interceptor_" + std::to_string(next_id++);
+    
+    std::lock_guard<std::mutex> lock(interceptors_mutex_);
+    auto table = interceptors_ ? std::make_shared<InterceptorTable>(*interceptors_) : std::make_shared<InterceptorTable>();
+    table->scoped.push_back({id, TopicFilterFactory::create(std::string(topic_pattern)), std::move(interceptor)});
+    store_interceptors(std::move(table));
+    
+    return id;
+}
+
+bool Broker::remove_interceptor(const std::string& interceptor_id) {
+    std::lock_guard<std::mutex> lock(interceptors_mutex_);
+    if (!interceptors_) {
+        return false;
+    }
+    
+    auto table = std::make_shared<InterceptorTable>(*interceptors_);
+    auto it = std::find_if(table->scoped.begin(), table->scoped.end(), [&interceptor_id](const auto& scoped) {
+        return scoped.id == interceptor_id;
+    });
+    if (it == table->scoped.end()) {
+        return false;
+    }
+    table->scoped.erase(it);
+    store_interceptors(std::move(table));
+    
+    return true;
+}
+
+void Broker::store_interceptors(std::shared_ptr<const InterceptorTable> table) {
+    bool active = table && (!table->global.empty() || !table->scoped.empty());
+    
+    // Readers that announced this epoch or an older one may still hold the old table
+    if (interceptors_) {
+        retired_interceptors_.emplace_back(interceptors_epoch_.load(), std::move(interceptors_));
+    }
+    interceptors_ = std::move(table);
+    active_interceptors_.store(active ? interceptors_.get() : nullptr);
+    interceptors_epoch_.fetch_add(1);
+    
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (const auto& reader : interceptor_readers_) {
+        uint64_t epoch = reader.epoch.load();
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+    retired_interceptors_.erase(
+        std::remove_if(retired_interceptors_.begin(), retired_interceptors_.end(),
+                       [oldest](const auto& retired) { return retired.first < oldest; }),
+        retired_interceptors_.end());
+}
+
+void Broker::register_interceptor_reader() {
+    std::lock_guard<std::mutex> lock(interceptors_mutex_);
+    interceptor_reader_ = &interceptor_readers_.emplace_back();
+}
+
+Broker::InterceptorGuard Broker::load_interceptors() const {
+    // Nothing to protect while no interceptor is installed
+    if (!active_interceptors_.load(std::memory_order_relaxed)) {
+        return InterceptorGuard();
+    }
+    
+    // The announcement is ordered before the load (pairs with the scan in store_interceptors())
+    interceptor_reader_->epoch.store(interceptors_epoch_.load());
+    return InterceptorGuard(interceptor_reader_, active_interceptors_.load());
+}
+
+bool Broker::intercept(const InterceptorTable& table, Message& message, DeliveryReport* report) {
+    auto passes = [&message](MessageInterceptor& interceptor) {
+        try {
+            return interceptor.intercept(message) == InterceptResult::Continue;
+        } catch (...) {
+            return false;
+        }
+    };
+    
+    bool passed = std::all_of(table.global.begin(), table.global.end(), [&passes](const auto& interceptor) {
+        return passes(*interceptor);
+    });
+    
+    // Topic-level interceptors only see messages the broker-wide ones let through
+    for (size_t i = 0; passed && i < table.scoped.size(); ++i) {
+        const auto& scoped = table.scoped[i];
+        if (scoped.filter->matches(message.topic())) {
+            passed = passes(*scoped.interceptor);
+        }
+    }
+    
+    if (!passed) {
+        intercepted_messages_++;
+        if (report) {
+            report->intercepted = true;
+        }
+    }
+    return passed;
+}
+
+bool Broker::update_peer_interest(const std::string& peer_id, const InterestChange& change) {
+    std::lock_guard<std::mutex> lock(federation_mutex_);
+    
+    auto it = peers_.find(peer_id);
+    if (it == peers_.end()) {
+        return false;
+    }
+    
+    auto& interest = it->second.interest;
+    for (const auto& pattern : change.removed) {
+        interest.erase(pattern);
+    }
+    for (const auto& pattern : change.added) {
+        interest.emplace(pattern, TopicFilterFactory::create(pattern));
+    }
+    
+    return true;
+}
+
+std::vector<std::string> Broker::get_local_interest() const {
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    return local_interest_.patterns();
+}
+
+void Broker::forward_to_peers(std::string_view topic, const std::shared_ptr<Message>& message) {
+    std::vector<std::shared_ptr<FederationLink>> targets;
+    {
+        std::lock_guard<std::mutex> lock(federation_mutex_);
+        
+        // Peers advertise a minimal cover, so a single matching pattern decides
+        for (const auto& pair : peers_) {
+            for (const auto& filter : pair.second.interest) {
+                if (filter.second->matches(topic)) {
+                    targets.push_back(pair.second.link);
+                    break;
+                }
+            }
+        }
+    }
+    
+    for (const auto& link : targets) {
+        link->send_message(message);
+    }
+    forwarded_messages_ += targets.size();
+}
+
+void Broker::update_local_interest(const std::string& pattern, bool subscribed) {
+    std::lock_guard<std::mutex> lock(interest_mutex_);
+    
+    InterestChange change = subscribed ? local_interest_.add(pattern) : local_interest_.remove(pattern);
+    if (change.empty()) {
+        return;
+    }
+    
+    std::vector<std::shared_ptr<FederationLink>> links;
+    {
+        std::lock_guard<std::mutex> peers_lock(federation_mutex_);
+        links.reserve(peers_.size());
+        for (const auto& pair : peers_) {
+            links.push_back(pair.second.link);
+        }
+    }
+    
+    for (const auto& link : links) {
+        link->send_interest(change);
+    }
+}
 
 std::shared_ptr<Topic> Broker::get_or_create_topic(std::string_view topic_name) {
     std::lock_guard<std::mutex> lock(topics_mutex_);
@@ -242,23 +1237,238 @@ std::shared_ptr<Topic> Broker::get_or_create_topic(std::string_view topic_name)
     auto it = topics_.find(topic_str);
     
     if (it == topics_.end()) {
+        if (auto restored = materialize_snapshot_topic(topic_str)) {
+            return restored;
+        }
+        
         // Create a new topic
         auto topic = std::make_shared<Topic>(topic_str);
         
         // Store the topic
         topics_[topic_str] = topic;
+        topic_names_.insert(topic->name());
         
         return topic;
     }
     
+    it->second->touch();
     return it->second;
 }
 
-void Broker::worker_thread() {
+std::shared_ptr<Topic> Broker::cached_topic(std::string_view topic_name) {
+    struct CachedTopic {
+        uint64_t generation = 0;
+        std::shared_ptr<Topic> topic;
+    };
+    thread_local std::array<CachedTopic, 64> cache;
+    
+    auto& entry = cache[std::hash<std::string_view>{}(topic_name) % cache.size()];
+    uint64_t generation = topics_generation_.load(std::memory_order_acquire);
+    if (entry.generation != generation || !entry.topic || entry.topic->name() != topic_name) {
+        entry.topic = get_or_create_topic(topic_name);
+        entry.generation = generation;
+    }
+    
+    return entry.topic;
+}
+
+std::shared_ptr<Topic> Broker::materialize_snapshot_topic(const std::string& topic_name) {
+    size_t index = 0;
+    if (!snapshot_ || snapshot_pending_ == 0 || !snapshot_->find(topic_name, index) || snapshot_loaded_[index]) {
+        return nullptr;
+    }
+    
+    auto topic = std::make_shared<Topic>(topic_name);
+    for (auto& message : snapshot_->load_messages(index, config_.snapshot_serializer)) {
+        size_t bytes = message->approximate_size();
+        retained_bytes_ += static_cast<size_t>(topic->retain(std::move(message), config_.max_retained_messages, bytes).value_or(0));
+    }
+    
+    topics_[topic_name] = topic;
+    topic_names_.insert(topic->name());
+    snapshot_loaded_[index] = true;
+    snapshot_pending_--;
+    
+    return topic;
+}
+
+void Broker::deliver_retained(const std::shared_ptr<Subscription>& subscription) {
+    std::vector<std::shared_ptr<Topic>> matching;
+    {
+        std::lock_guard<std::mutex> lock(topics_mutex_);
+        const auto& filter = subscription->filter();
+        std::string_view pattern = filter->pattern();
+        
+        if (dynamic_cast<const ExactTopicFilter*>(filter.get())) {
+            // An exact pattern names at most one topic
+            std::string name(pattern);
+            auto it = topics_.find(name);
+            if (it != topics_.end()) {
+                matching.push_back(it->second);
+            } else if (auto topic = materialize_snapshot_topic(name)) {
+                matching.push_back(std::move(topic));
+            }
+        } else {
+            // Only names sharing the literal head of the pattern can match
+            std::string_view prefix;
+            if (pattern.find_first_of("?{}|") == std::string_view::npos) {
+                prefix = pattern.substr(0, std::min(pattern.find_first_of("+#"), pattern.size()));
+            }
+            auto has_prefix = [prefix](std::string_view name) {
+                return name.substr(0, prefix.size()) == prefix;
+            };
+            
+            for (auto it = topic_names_.lower_bound(prefix); it != topic_names_.end() && has_prefix(*it); ++it) {
+                if (subscription->matches(*it)) {
+                    matching.push_back(topics_.find(std::string(*it))->second);
+                }
+            }
+            
+            if (snapshot_ && snapshot_pending_ > 0) {
+                std::vector<std::string> restored;
+                for (size_t i = snapshot_->lower_bound(prefix); i < snapshot_->topic_count(); ++i) {
+                    std::string_view name = snapshot_->topic_name(i);
+                    if (!has_prefix(name)) {
+                        break;
+                    }
+                    if (!snapshot_loaded_[i] && subscription->matches(name)) {
+                        restored.emplace_back(name);
+                    }
+                }
+                for (const auto& name : restored) {
+                    if (auto topic = materialize_snapshot_topic(name)) {
+                        matching.push_back(std::move(topic));
+                    }
+                }
+            }
+        }
+    }
+    
+    for (const auto& topic : matching) {
+        for (const auto& message : topic->retained_messages()) {
+            if (subscription->dispatch(message) == DeliveryResult::Success) {
+                delivered_messages_++;
+            }
+        }
+    }
+}
+
+void Broker::maintenance_thread() {
+    using Clock = std::chrono::steady_clock;
+    
+    const bool periodic_snapshots = !config_.snapshot_path.empty() && config_.snapshot_interval_ms > 0;
+    const auto snapshot_interval = std::chrono::milliseconds(config_.snapshot_interval_ms);
+    
+    // Sweep often enough that a full pass over a small map stays well within the idle timeout
+    const bool collect_topics = config_.topic_idle_timeout_ms > 0;
+    const auto gc_interval = std::chrono::milliseconds(
+        std::clamp<uint64_t>(config_.topic_idle_timeout_ms / 8, 10, 1000));
+    
+    // Staged messages of idle publishers wait at most about 1.5x publish_staging_us
+    const bool aged_staging = config_.publish_staging_size > 0 && config_.publish_staging_us > 0;
+    const auto staging_interval = std::chrono::microseconds(std::max<uint64_t>(config_.publish_staging_us / 2, 50));
+    
+    std::chrono::microseconds tick = periodic_snapshots ? snapshot_interval : std::chrono::microseconds(gc_interval);
+    if (collect_topics) {
+        tick = std::min<std::chrono::microseconds>(tick, gc_interval);
+    }
+    if (aged_staging) {
+        tick = std::min(tick, staging_interval);
+    }
+    auto next_snapshot = Clock::now() + snapshot_interval;
+    auto next_gc = Clock::now() + gc_interval;
+    
+    std::unique_lock<std::mutex> lock(maintenance_mutex_);
     while (running_) {
-        std::shared_ptr<Message> message;
+        maintenance_cv_.wait_for(lock, tick, [this]() {
+            return !running_;
+        });
+        
+        if (!running_) {
+            break;
+        }
         
-        // Wait for a message to process
+        lock.unlock();
+        if (aged_staging) {
+            flush_staging_buffers(true);
+        }
+        if (collect_topics && Clock::now() >= next_gc) {
+            collect_idle_topics(std::max<size_t>(config_.topic_gc_batch, 1));
+            next_gc = Clock::now() + gc_interval;
+        }
+        if (periodic_snapshots && Clock::now() >= next_snapshot) {
+            save_snapshot();
+            next_snapshot = Clock::now() + snapshot_interval;
+        }
+        lock.lock();
+    }
+}
+
+size_t Broker::collect_idle_topics(size_t max_buckets) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto idle_timeout = std::chrono::milliseconds(config_.topic_idle_timeout_ms);
+    
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    // Subscriptions live in the routing index, not in the topics themselves
+    std::lock_guard<std::mutex> sub_lock(subscriptions_mutex_);
+    
+    // Erasing never rehashes, so the cursor stays meaningful between steps
+    size_t bucket_count = topics_.bucket_count();
+    std::vector<std::string> idle;
+    for (size_t i = 0; i < max_buckets && i < bucket_count; ++i) {
+        if (gc_cursor_ >= bucket_count) {
+            gc_cursor_ = 0;
+        }
+        for (auto it = topics_.begin(gc_cursor_); it != topics_.end(gc_cursor_); ++it) {
+            const std::string& name = it->first;
+            if (it->second->retire_if_idle(now, idle_timeout, [this, &name]() { return has_subscribers(name); })) {
+                idle.push_back(it->first);
+            }
+        }
+        gc_cursor_++;
+    }
+    
+    for (const auto& name : idle) {
+        topic_names_.erase(name);
+        topics_.erase(name);
+    }
+    if (!idle.empty()) {
+        topics_generation_++;
+    }
+    
+    evicted_topics_ += idle.size();
+    return idle.size();
+}
+
+bool Broker::has_subscribers(std::string_view topic_name) {
+    std::vector<std::shared_ptr<Subscription>> matching;
+    if (automaton_) {
+        automaton_->match(topic_name, matching);
+    } else {
+        subscription_table_->match(topic_name, matching);
+    }
+    if (!matching.empty()) {
+        return true;
+    }
+    
+    for (const auto& pair : share_groups_) {
+        if (pair.second->matches(topic_name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Broker::worker_thread() {
+    register_interceptor_reader();
+    std::vector<QueuedMessage> batch;
+    
+    // Keep going after shutdown until the queue is drained
+    for (;;) {
+        size_t remaining = 0;
+        
+        // Wait for messages to process
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             
@@ -270,38 +1480,667 @@ void Broker::worker_thread() {
                 return;
             }
             
-            if (!message_queue_.empty()) {
-                message = message_queue_.front();
+            // Leave a fair share of the backlog to the other workers
+            size_t limit = config_.adaptive_batching ? batch_size_.load(std::memory_order_relaxed) : 1;
+            size_t share = (message_queue_.size() + config_.thread_count - 1) / std::max<size_t>(config_.thread_count, 1);
+            limit = std::clamp<size_t>(share, 1, limit);
+            while (batch.size() < limit && !message_queue_.empty()) {
+                QueuedMessage& item = message_queue_.front();
+                queued_bytes_ -= item.bytes;
+                in_flight_bytes_ += item.bytes;
+                batch.push_back(std::move(item));
                 message_queue_.pop();
             }
+            remaining = message_queue_.size();
         }
         
-        if (message) {
-            process_message(message);
+        if (batch.empty()) {
+            continue;
+        }
+        
+        uint64_t started = config_.adaptive_batching ? TickClock::now() : 0;
+        
+        if (batch.size() == 1) {
+            QueuedMessage& item = batch.front();
+            process_message(item.message, item.bytes, item.completion ? &item.completion->report : nullptr);
+            in_flight_bytes_ -= item.bytes;
+            if (item.completion) {
+                finish_publish(*item.completion);
+            }
+        } else {
+            process_batch(batch);
         }
+        
+        if (config_.adaptive_batching) {
+            auto elapsed = TickClock::elapsed(started, TickClock::now());
+            adapt_batch_size(batch.size(), static_cast<uint64_t>(std::max<int64_t>(elapsed.count(), 0)), remaining);
+        }
+        
+        batch.clear();
     }
 }
 
-void Broker::process_message(std::shared_ptr<Message> message) {
-    // Find matching subscriptions
-    std::vector<std::shared_ptr<Subscription>> matching_subs;
+bool Broker::ring_publish(std::string_view topic_str, std::shared_ptr<Message> message, size_t bytes,
+                          std::shared_ptr<PublishCompletion> completion) {
+    auto over_bytes = [this, bytes]() {
+        return (config_.max_queue_bytes > 0 && queued_bytes_.load() + bytes > config_.max_queue_bytes) ||
+               (config_.memory_budget_bytes > 0 && memory_in_use() + bytes > config_.memory_budget_bytes);
+    };
+    
+    if (over_bytes() && !(reclaim_retained(topic_str, bytes) > 0 && !over_bytes())) {
+        dropped_messages_++;
+        return false;
+    }
+    
+    // Registered before running_ is checked, so shutdown() can wait for every
+    // publisher that may still write a slot before it clears the ring
+    ring_publishers_.fetch_add(1);
+    if (!running_) {
+        ring_publishers_.fetch_sub(1);
+        dropped_messages_++;
+        return false;
+    }
+    
+    // A ring cannot evict, so under DropOldest the publisher waits for a free slot instead
+    int64_t sequence = 0;
+    bool claimed = config_.overflow_policy == OverflowPolicy::DropOldest
+        ? ring_->claim([this]() { return running_.load(); }, sequence)
+        : ring_->try_claim(sequence);
+    if (!claimed) {
+        // An abandoned claim stays unpublished: its slot still holds an undelivered
+        // message, and the router stops at the gap once running_ is cleared
+        ring_publishers_.fetch_sub(1);
+        dropped_messages_++;
+        return false;
+    }
+    
+    RingSlot& slot = (*ring_)[sequence];
+    slot.message = std::move(message);
+    slot.bytes = bytes;
+    slot.completion = std::move(completion);
+    if (slot.completion) {
+        slot.completion->report.accepted = true;
+    }
+    queued_bytes_ += bytes;
+    
+    ring_->publish(sequence);
+    ring_publishers_.fetch_sub(1);
+    ring_wake();
+    return true;
+}
+
+void Broker::ring_router_thread() {
+    register_interceptor_reader();
+    int64_t next = ring_routed_.get() + 1;
+    
+    while (ring_wait([this, &next]() { return ring_->is_available(next); }, running_)) {
+        // Everything published contiguously so far is routed as one batch
+        int64_t last = ring_->highest_available(next);
+        
+        // A dropped slot is emptied here so the delivery workers skip it
+        if (auto table = load_interceptors()) {
+            for (int64_t sequence = next; sequence <= last; ++sequence) {
+                RingSlot& slot = (*ring_)[sequence];
+                if (slot.message &&
+                    !intercept(*table, *slot.message, slot.completion ? &slot.completion->report : nullptr)) {
+                    queued_bytes_ -= slot.bytes;
+                    slot.message.reset();
+                    if (slot.completion) {
+                        finish_publish(*slot.completion);
+                        slot.completion.reset();
+                    }
+                }
+            }
+        }
+        
+        if (config_.retain_messages) {
+            for (int64_t sequence = next; sequence <= last; ++sequence) {
+                RingSlot& slot = (*ring_)[sequence];
+                if (slot.message) {
+                    retain_message(slot.message, slot.bytes);
+                }
+            }
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+            for (int64_t sequence = next; sequence <= last; ++sequence) {
+                RingSlot& slot = (*ring_)[sequence];
+                if (slot.message) {
+                    collect_matching(*slot.message, slot.targets, &slot.groups);
+                }
+            }
+        }
+        
+        ring_routed_.set(last);
+        ring_wake();
+        next = last + 1;
+    }
+    
+    // Delivery workers finish the routed slots, then exit
+    ring_routing_ = false;
+    ring_wake();
+}
+
+void Broker::ring_delivery_thread(size_t index) {
+    Sequence& cursor = *ring_delivered_[index];
+    const auto workers = static_cast<int64_t>(ring_delivered_.size());
+    const auto self = static_cast<int64_t>(index);
+    int64_t next = cursor.get() + 1;
+    
+    while (ring_wait([this, &next]() { return ring_routed_.get() >= next; }, ring_routing_)) {
+        int64_t last = ring_routed_.get();
+        
+        // Each worker owns every workers-th sequence
+        int64_t first = next + ((self - next % workers) + workers) % workers;
+        for (int64_t sequence = first; sequence <= last; sequence += workers) {
+            RingSlot& slot = (*ring_)[sequence];
+            if (slot.message) {
+                queued_bytes_ -= slot.bytes;
+                in_flight_bytes_ += slot.bytes;
+                select_members(*slot.message, slot.groups, slot.targets);
+                deliver_to(slot.message, slot.targets, slot.completion ? &slot.completion->report : nullptr);
+                in_flight_bytes_ -= slot.bytes;
+                if (slot.completion) {
+                    finish_publish(*slot.completion);
+                }
+            }
+            
+            slot.message.reset();
+            slot.completion.reset();
+            slot.targets.clear();
+            slot.groups.clear();
+        }
+        
+        // Passing sequences owned by other workers is fine: slots are gated by the slowest cursor
+        cursor.set(last);
+        ring_wake();
+        next = last + 1;
+    }
+}
+
+template<typename Ready>
+bool Broker::ring_wait(Ready ready, const std::atomic<bool>& active) {
+    // Once the flag is cleared, the condition is checked one last time
+    for (int spin = 0; spin < 512; ++spin) {
+        if (ready()) {
+            return true;
+        }
+        if (!active) {
+            return ready();
+        }
+    }
+    
+    for (int spin = 0; spin < 64; ++spin) {
+        if (ready()) {
+            return true;
+        }
+        if (!active) {
+            return ready();
+        }
+        std::this_thread::yield();
+    }
+    
+    // The timeout only bounds the cost of a wakeup lost to a racing publisher
+    std::unique_lock<std::mutex> lock(ring_mutex_);
+    ring_waiters_.fetch_add(1);
+    while (active && !ready()) {
+        ring_cv_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    ring_waiters_.fetch_sub(1);
+    
+    return ready();
+}
+
+void Broker::ring_wake() {
+    // Order the preceding publish before the waiter check (pairs with fetch_add in ring_wait)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring_waiters_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        ring_cv_.notify_all();
+    }
+}
+
+void Broker::clear_ring() {
+    int64_t last = ring_->claimed();
+    for (int64_t sequence = std::max<int64_t>(ring_->minimum_gating() + 1, last - static_cast<int64_t>(ring_->capacity()) + 1);
+         sequence <= last; ++sequence) {
+        RingSlot& slot = (*ring_)[sequence];
+        if (slot.message) {
+            queued_bytes_ -= slot.bytes;
+            dropped_messages_++;
+            if (slot.completion) {
+                slot.completion->report.evicted = true;
+            }
+        }
+        if (slot.completion) {
+            finish_publish(*slot.completion);
+        }
+        
+        slot.message.reset();
+        slot.completion.reset();
+        slot.targets.clear();
+        slot.groups.clear();
+    }
+}
+
+void Broker::clear_queue() {
+    MessageQueue leftovers(MessageQueue::container_type(ArenaAllocator<QueuedMessage>{arena_}));
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        std::swap(leftovers, message_queue_);
+    }
+    
+    // Completions run after the queue lock is released
+    while (!leftovers.empty()) {
+        QueuedMessage& item = leftovers.front();
+        queued_bytes_ -= item.bytes;
+        dropped_messages_++;
+        if (item.completion) {
+            item.completion->report.evicted = true;
+            finish_publish(*item.completion);
+        }
+        leftovers.pop();
+    }
+}
+
+void Broker::process_batch(std::vector<QueuedMessage>& batch) {
+    // Dropped messages lose their pointer but still complete below
+    if (auto table = load_interceptors()) {
+        for (auto& item : batch) {
+            if (!intercept(*table, *item.message, item.completion ? &item.completion->report : nullptr)) {
+                item.message.reset();
+            }
+        }
+    }
+    
+    if (config_.retain_messages) {
+        for (auto& item : batch) {
+            if (item.message) {
+                retain_message(item.message, item.bytes);
+            }
+        }
+    }
     
+    // One pass over the subscription table for the whole batch; share group
+    // members are picked per message as it is delivered
+    std::vector<std::vector<std::shared_ptr<Subscription>>> matching(batch.size());
+    std::vector<std::vector<std::shared_ptr<SubscriptionGroup>>> groups(batch.size());
     {
         std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (batch[i].message) {
+                collect_matching(*batch[i].message, matching[i], &groups[i]);
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < batch.size(); ++i) {
+        QueuedMessage& item = batch[i];
+        if (item.message) {
+            select_members(*item.message, groups[i], matching[i]);
+            deliver_to(item.message, matching[i], item.completion ? &item.completion->report : nullptr);
+        }
+        in_flight_bytes_ -= item.bytes;
+        if (item.completion) {
+            finish_publish(*item.completion);
+        }
+    }
+    
+    batched_messages_ += batch.size();
+}
+
+void Broker::adapt_batch_size(size_t processed, uint64_t elapsed_ns, size_t remaining) {
+    // Exponentially smoothed per-message cost
+    uint64_t cost = elapsed_ns / processed;
+    uint64_t previous = batch_cost_ns_.load(std::memory_order_relaxed);
+    uint64_t smoothed = previous == 0 ? cost : (previous * 7 + cost) / 8;
+    batch_cost_ns_.store(smoothed, std::memory_order_relaxed);
+    
+    // Largest batch whose last message waits at most max_batch_latency_us
+    size_t latency_cap = config_.max_batch_size;
+    if (smoothed > 0) {
+        uint64_t budget = config_.max_batch_latency_us * 1000 / smoothed;
+        latency_cap = static_cast<size_t>(std::min<uint64_t>(budget, config_.max_batch_size));
+    }
+    latency_cap = std::max<size_t>(latency_cap, 1);
+    
+    size_t current = batch_size_.load(std::memory_order_relaxed);
+    size_t next = current;
+    if (remaining > config_.batch_queue_threshold) {
+        next = current * 2;
+    } else if (remaining < config_.batch_queue_threshold / 2 || remaining == 0) {
+        next = current / 2;
+    }
+    next = std::clamp<size_t>(next, 1, latency_cap);
+    
+    if (next != current) {
+        batch_size_.store(next, std::memory_order_relaxed);
+    }
+}
+
+void Broker::lane_thread(PartitionLane& lane) {
+    register_interceptor_reader();
+    
+    // A stopped lane rejects new messages but still drains its queue
+    for (;;) {
+        PartitionedMessage item;
         
-        for (auto& pair : subscriptions_) {
-            if (pair.second->matches(message->topic())) {
-                matching_subs.push_back(pair.second);
+        // Wait for a message on this lane
+        {
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            
+            lane.cv.wait(lock, [&lane]() {
+                return lane.stopped || !lane.queue.empty();
+            });
+            
+            if (lane.queue.empty()) {
+                return;
             }
+            
+            item = std::move(lane.queue.front());
+            lane.queue.pop();
+            queued_bytes_ -= item.bytes;
+            in_flight_bytes_ += item.bytes;
+        }
+        
+        // A single thread per lane keeps every partition in order
+        if (item.message) {
+            size_t delivered = process_message(item.message, item.bytes,
+                                               item.completion ? &item.completion->report : nullptr);
+            item.topic->record_processed(item.partition, delivered);
+            in_flight_bytes_ -= item.bytes;
+            if (item.completion) {
+                finish_publish(*item.completion);
+            }
+        }
+    }
+}
+
+void Broker::start_partition_lanes() {
+    std::lock_guard<std::mutex> lock(lanes_mutex_);
+    
+    if (!lanes_.empty()) {
+        return;
+    }
+    
+    size_t count = config_.partition_lanes > 0 ? config_.partition_lanes : config_.thread_count;
+    lanes_.reserve(count);
+    
+    for (size_t i = 0; i < count; ++i) {
+        lanes_.push_back(std::make_shared<PartitionLane>());
+    }
+    
+    for (auto& lane : lanes_) {
+        PartitionLane* lane_ptr = lane.get();
+        lane->thread = std::thread([this, lane_ptr]() {
+            lane_thread(*lane_ptr);
+        });
+    }
+}
+
+void Broker::stop_partition_lanes() {
+    // Join outside lanes_mutex_: callbacks on the lanes may still publish
+    std::vector<std::shared_ptr<PartitionLane>> lanes;
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        lanes.swap(lanes_);
+        partitioned_topic_count_.store(0, std::memory_order_release);
+    }
+    
+    for (auto& lane : lanes) {
+        {
+            std::lock_guard<std::mutex> lane_lock(lane->mutex);
+            lane->stopped = true;
+        }
+        lane->cv.notify_all();
+        
+        if (lane->thread.joinable()) {
+            lane->thread.join();
+        }
+    }
+}
+
+bool Broker::publish_partitioned(const std::shared_ptr<Topic>& topic, std::shared_ptr<Message> message,
+                                 size_t bytes, std::shared_ptr<PublishCompletion> completion) {
+    size_t partition = topic->select_partition(*message, config_.partition_key_header);
+    
+    std::shared_ptr<PartitionLane> lane;
+    {
+        std::lock_guard<std::mutex> lock(lanes_mutex_);
+        if (!lanes_.empty()) {
+            lane = lanes_[partition % lanes_.size()];
+        }
+    }
+    if (!lane) {
+        dropped_messages_++;
+        return false;
+    }
+    
+    // Apply the queue limit per lane; evicted messages still count as processed
+    std::vector<std::shared_ptr<PublishCompletion>> evicted;
+    auto on_evict = [&evicted](PartitionedMessage& oldest) {
+        oldest.topic->record_processed(oldest.partition, 0);
+        if (oldest.completion) {
+            evicted.push_back(std::move(oldest.completion));
         }
+    };
+    
+    auto try_enqueue = [&]() {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        
+        if (lane->stopped || !make_room(lane->queue, bytes, on_evict)) {
+            return false;
+        }
+        
+        if (completion) {
+            completion->report.accepted = true;
+        }
+        topic->record_published(partition);
+        lane->queue.push(PartitionedMessage{std::move(message), bytes, topic, partition, std::move(completion)});
+        queued_bytes_ += bytes;
+        return true;
+    };
+    
+    // Retained memory is reclaimed with the lane lock released, as in enqueue_message()
+    bool queued = try_enqueue() || (reclaim_retained(topic->name(), bytes) > 0 && try_enqueue());
+    
+    for (auto& oldest : evicted) {
+        oldest->report.evicted = true;
+        finish_publish(*oldest);
+    }
+    
+    if (!queued) {
+        dropped_messages_++;
+        return false;
+    }
+    
+    lane->cv.notify_one();
+    
+    return true;
+}
+
+size_t Broker::memory_in_use() const {
+    return queued_bytes_.load(std::memory_order_relaxed) +
+           in_flight_bytes_.load(std::memory_order_relaxed) +
+           retained_bytes_.load(std::memory_order_relaxed);
+}
+
+template<typename Queue, typename OnEvict>
+bool Broker::make_room(Queue& queue, size_t bytes, OnEvict on_evict) {
+    auto over_limit = [this, &queue, bytes]() {
+        return (config_.max_queue_size > 0 && queue.size() >= config_.max_queue_size) ||
+               (config_.max_queue_bytes > 0 && queued_bytes_.load() + bytes > config_.max_queue_bytes) ||
+               (config_.memory_budget_bytes > 0 && memory_in_use() + bytes > config_.memory_budget_bytes);
+    };
+    
+    if (!over_limit()) {
+        return true;
     }
     
+    // A message larger than a limit on its own would only flush the queue
+    if (config_.overflow_policy != OverflowPolicy::DropOldest ||
+        (config_.max_queue_bytes > 0 && bytes > config_.max_queue_bytes) ||
+        (config_.memory_budget_bytes > 0 && bytes > config_.memory_budget_bytes)) {
+        return false;
+    }
+    
+    while (!queue.empty() && over_limit()) {
+        auto& oldest = queue.front();
+        queued_bytes_ -= oldest.bytes;
+        on_evict(oldest);
+        queue.pop();
+        dropped_messages_++;
+    }
+    
+    return !over_limit();
+}
+
+size_t Broker::reclaim_retained(std::string_view preferred_topic, size_t bytes) {
+    if (config_.memory_budget_bytes == 0 || retained_bytes_.load() == 0) {
+        return 0;
+    }
+    
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    
+    // Start with the publishing topic, then take from any topic until enough is freed
+    size_t freed = 0;
+    auto it = topics_.find(std::string(preferred_topic));
+    if (it != topics_.end()) {
+        freed += it->second->evict_retained(bytes);
+    }
+    
+    for (auto& pair : topics_) {
+        if (freed >= bytes) {
+            break;
+        }
+        freed += pair.second->evict_retained(bytes - freed);
+    }
+    
+    retained_bytes_ -= freed;
+    return freed;
+}
+
+void Broker::retain_message(const std::shared_ptr<Message>& message, size_t bytes) {
+    // A topic retired by the idle collector rejects the message; look it up again
+    for (bool cached = true;; cached = false) {
+        auto topic = cached ? cached_topic(message->topic()) : get_or_create_topic(message->topic());
+        
+        // The message is already counted as in flight, so only check the current usage
+        if (config_.memory_budget_bytes > 0 && memory_in_use() > config_.memory_budget_bytes) {
+            size_t excess = memory_in_use() - config_.memory_budget_bytes;
+            retained_bytes_ -= topic->evict_retained(excess);
+            if (memory_in_use() > config_.memory_budget_bytes) {
+                return;
+            }
+        }
+        
+        auto delta = topic->retain(message, config_.max_retained_messages, bytes);
+        if (!delta) {
+            continue;
+        }
+        
+        if (*delta >= 0) {
+            retained_bytes_ += static_cast<size_t>(*delta);
+        } else {
+            retained_bytes_ -= static_cast<size_t>(-*delta);
+        }
+        return;
+    }
+}
+
+size_t Broker::process_message(const std::shared_ptr<Message>& message, size_t bytes,
+                               DeliveryReport* report) {
+    if (auto table = load_interceptors()) {
+        if (!intercept(*table, *message, report)) {
+            return 0;
+        }
+    }
+    
+    // Keep the most recent messages for late subscribers
+    if (config_.retain_messages) {
+        retain_message(message, bytes);
+    }
+    
+    // Find matching subscriptions
+    std::vector<std::shared_ptr<Subscription>> matching_subs;
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        collect_matching(*message, matching_subs);
+    }
+    
+    return deliver_to(message, matching_subs, report);
+}
+
+void Broker::collect_matching(const Message& message, std::vector<std::shared_ptr<Subscription>>& matching,
+                              std::vector<std::shared_ptr<SubscriptionGroup>>* groups) {
+    if (automaton_) {
+        automaton_->match(message.topic(), matching);
+    } else {
+        subscription_table_->match(message.topic(), matching);
+    }
+    
+    // Each matching shared group contributes exactly one member
+    for (auto& pair : share_groups_) {
+        if (pair.second->matches(message.topic())) {
+            if (groups) {
+                groups->push_back(pair.second);
+            } else if (auto member = pair.second->select(message)) {
+                matching.push_back(std::move(member));
+            }
+        }
+    }
+}
+
+void Broker::select_members(const Message& message, const std::vector<std::shared_ptr<SubscriptionGroup>>& groups,
+                            std::vector<std::shared_ptr<Subscription>>& matching) {
+    if (groups.empty()) {
+        return;
+    }
+    
+    // Group membership is guarded by the subscriptions mutex
+    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+    for (const auto& group : groups) {
+        if (auto member = group->select(message)) {
+            matching.push_back(std::move(member));
+        }
+    }
+}
+
+size_t Broker::deliver_to(const std::shared_ptr<Message>& message,
+                          const std::vector<std::shared_ptr<Subscription>>& subscriptions,
+                          DeliveryReport* report) {
     // Deliver the message to each matching subscription
-    for (auto& sub : matching_subs) {
-        if (sub->deliver(message) == DeliveryResult::Success) {
-            delivered_messages_++;
+    size_t delivered = 0;
+    for (const auto& sub : subscriptions) {
+        // The routing indexes already matched the topic
+        DeliveryResult result = sub->dispatch(message);
+        if (result == DeliveryResult::Success) {
+            delivered++;
+        }
+        
+        if (report) {
+            switch (result) {
+                case DeliveryResult::Success:
+                    report->delivered++;
+                    break;
+                case DeliveryResult::Filtered:
+                    report->filtered++;
+                    break;
+                case DeliveryResult::Rejected:
+                    report->rejected++;
+                    break;
+                case DeliveryResult::Timeout:
+                case DeliveryResult::Error:
+                    report->errored++;
+                    break;
+            }
         }
     }
+    
+    delivered_messages_ += delivered;
+    
+    return delivered;
 }
 
 } // namespace pubsub 
\ No newline at end of file
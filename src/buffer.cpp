@@ -0,0 +1,118 @@
+#include "pubsub/buffer.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace pubsub {
+
+// Buffer implementation
+Buffer::Buffer(std::shared_ptr<const void> owner, const uint8_t* data, size_t size)
+    : owner_(std::move(owner))
+    , data_(data)
+    , size_(size) {
+}
+
+Buffer Buffer::copy(const void* data, size_t size) {
+    if (size == 0) {
+        return Buffer();
+    }
+
+    std::vector<uint8_t> bytes(size);
+    std::memcpy(bytes.data(), data, size);
+    return adopt(std::move(bytes));
+}
+
+Buffer Buffer::adopt(std::vector<uint8_t>&& data) {
+    if (data.empty()) {
+        return Buffer();
+    }
+
+    auto owner = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+    const uint8_t* bytes = owner->data();
+    size_t size = owner->size();
+    return Buffer(std::move(owner), bytes, size);
+}
+
+Buffer Buffer::adopt(std::string&& data) {
+    if (data.empty()) {
+        return Buffer();
+    }
+
+    auto owner = std::make_shared<const std::string>(std::move(data));
+    const auto* bytes = reinterpret_cast<const uint8_t*>(owner->data());
+    size_t size = owner->size();
+    return Buffer(std::move(owner), bytes, size);
+}
+
+Buffer Buffer::wrap(const void* data, size_t size, Deleter deleter) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+
+    std::shared_ptr<const void> owner(data, [bytes, size, deleter = std::move(deleter)](const void*) {
+        if (deleter) {
+            deleter(bytes, size);
+        }
+    });
+
+    return Buffer(std::move(owner), bytes, size);
+}
+
+Buffer Buffer::slice(size_t offset, size_t length) const {
+    if (offset > size_) {
+        throw std::out_of_range("Buffer slice offset out of range");
+    }
+
+    size_t available = size_ - offset;
+    if (length > available) {
+        length = available;
+    }
+
+    return Buffer(owner_, data_ + offset, length);
+}
+
+std::string_view Buffer::view() const {
+    return std::string_view(reinterpret_cast<const char*>(data_), size_);
+}
+
+std::vector<uint8_t> Buffer::to_vector() const {
+    return std::vector<uint8_t>(begin(), end());
+}
+
+// BufferChain implementation
+BufferChain::BufferChain(std::vector<Buffer> buffers) {
+    buffers_.reserve(buffers.size());
+    for (auto& buffer : buffers) {
+        append(std::move(buffer));
+    }
+}
+
+void BufferChain::append(Buffer buffer) {
+    if (buffer.empty()) {
+        return;
+    }
+
+    size_ += buffer.size();
+    buffers_.push_back(std::move(buffer));
+}
+
+Buffer BufferChain::flatten() const {
+    if (buffers_.empty()) {
+        return Buffer();
+    }
+
+    if (buffers_.size() == 1) {
+        return buffers_.front();
+    }
+
+    std::vector<uint8_t> bytes(size_);
+    copy_to(bytes.data());
+    return Buffer::adopt(std::move(bytes));
+}
+
+void BufferChain::copy_to(uint8_t* out) const {
+    for (const auto& buffer : buffers_) {
+        std::memcpy(out, buffer.data(), buffer.size());
+        out += buffer.size();
+    }
+}
+
+} // namespace pubsub
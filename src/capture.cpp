@@ -0,0 +1,210 @@
+#include "pubsub/capture.hpp"
+#include "pubsub/broker.hpp"
+#include "binary_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace pubsub {
+
+using detail::append_bytes;
+using detail::append_string;
+using detail::append_value;
+using detail::RecordReader;
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'S', 'C', 'A', 'P', '0', '0', '1'};
+
+} // namespace
+
+// PublishRecorder implementation
+PublishRecorder::PublishRecorder(const std::string& path, std::shared_ptr<MessageSerializer> serializer)
+    : serializer_(std::move(serializer))
+    , started_(Clock::now()) {
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ && std::fwrite(kMagic, 1, sizeof(kMagic), file_) != sizeof(kMagic)) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+PublishRecorder::~PublishRecorder() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool PublishRecorder::is_open() const {
+    return file_ != nullptr;
+}
+
+void PublishRecorder::record(std::string_view topic, const Message& message) {
+    if (!file_) {
+        return;
+    }
+
+    // Serialize outside the lock; only the file append is serialized
+    BufferChain payload;
+    if (serializer_) {
+        payload = message.serialize_chain(*serializer_);
+    } else if (message.has_encoded_payload()) {
+        payload.append(message.encoded_payload());
+    } else if (message.has_payload_type<Buffer>()) {
+        payload.append(message.payload<Buffer>());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto offset = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started_).count();
+
+    // Record layout: size, offset, priority, topic, headers, payload
+    scratch_.clear();
+    append_value<uint32_t>(scratch_, 0);
+    append_value<int64_t>(scratch_, static_cast<int64_t>(offset));
+    append_value<uint8_t>(scratch_, static_cast<uint8_t>(message.priority()));
+    append_string(scratch_, topic);
+    append_value<uint32_t>(scratch_, static_cast<uint32_t>(message.headers().size()));
+    for (const auto& [key, value] : message.headers()) {
+        append_string(scratch_, key);
+        append_string(scratch_, value);
+    }
+    append_value<uint64_t>(scratch_, payload.size());
+
+    uint32_t record_size = static_cast<uint32_t>(scratch_.size() - sizeof(uint32_t) + payload.size());
+    std::memcpy(scratch_.data(), &record_size, sizeof(record_size));
+
+    std::fwrite(scratch_.data(), 1, scratch_.size(), file_);
+    for (const auto& segment : payload.buffers()) {
+        std::fwrite(segment.data(), 1, segment.size(), file_);
+    }
+
+    record_count_++;
+}
+
+size_t PublishRecorder::record_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return record_count_;
+}
+
+// CaptureReader implementation
+CaptureReader::CaptureReader(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        return;
+    }
+
+    char magic[sizeof(kMagic)];
+    if (std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic) ||
+        std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+CaptureReader::~CaptureReader() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool CaptureReader::is_open() const {
+    return file_ != nullptr;
+}
+
+bool CaptureReader::next(CaptureRecord& record) {
+    if (!file_) {
+        return false;
+    }
+
+    uint32_t record_size = 0;
+    if (std::fread(&record_size, 1, sizeof(record_size), file_) != sizeof(record_size)) {
+        return false;
+    }
+
+    // The record body becomes the payload's backing store, so no second copy is made
+    std::vector<uint8_t> body(record_size);
+    if (std::fread(body.data(), 1, body.size(), file_) != body.size()) {
+        return false;
+    }
+    Buffer bytes = Buffer::adopt(std::move(body));
+
+    RecordReader reader(bytes.data(), bytes.size());
+    int64_t offset = 0;
+    uint8_t priority = 0;
+    uint32_t header_count = 0;
+    if (!reader.read(offset) || !reader.read(priority) ||
+        !reader.read_string(record.topic) || !reader.read(header_count)) {
+        return false;
+    }
+
+    record.offset = std::chrono::nanoseconds(offset);
+    record.priority = static_cast<Priority>(std::min<uint8_t>(priority, static_cast<uint8_t>(Priority::Critical)));
+
+    record.headers.clear();
+    for (uint32_t i = 0; i < header_count; ++i) {
+        std::string key;
+        std::string value;
+        if (!reader.read_string(key) || !reader.read_string(value)) {
+            return false;
+        }
+        record.headers.emplace(std::move(key), std::move(value));
+    }
+
+    uint64_t payload_size = 0;
+    const uint8_t* payload = nullptr;
+    if (!reader.read(payload_size) || !reader.read_bytes(static_cast<size_t>(payload_size), payload)) {
+        return false;
+    }
+    record.payload = bytes.slice(reader.position() - static_cast<size_t>(payload_size));
+
+    return true;
+}
+
+// Replay
+ReplayStats replay_capture(Broker& broker, CaptureReader& reader, const ReplayOptions& options) {
+    using Clock = std::chrono::steady_clock;
+
+    ReplayStats stats;
+    const auto started = Clock::now();
+    CaptureRecord record;
+
+    while (reader.next(record)) {
+        stats.records++;
+
+        // Pace publishes against the scaled original schedule
+        if (options.speed > 0) {
+            auto scheduled = started + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::nano>(record.offset.count() / options.speed));
+            auto now = Clock::now();
+            if (scheduled > now) {
+                std::this_thread::sleep_until(scheduled);
+            } else {
+                stats.max_lag = std::max(stats.max_lag,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - scheduled));
+            }
+        }
+
+        auto message = std::make_shared<Message>(record.topic);
+        message->set_priority(record.priority);
+        message->headers() = std::move(record.headers);
+        if (options.serializer) {
+            message->set_encoded_payload(record.payload, options.serializer);
+        } else {
+            message->set_payload(record.payload);
+        }
+
+        if (broker.publish(record.topic, std::move(message))) {
+            stats.published++;
+        } else {
+            stats.dropped++;
+        }
+    }
+
+    stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+    return stats;
+}
+
+} // namespace pubsub
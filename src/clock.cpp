@@ -0,0 +1,203 @@
+#include "pubsub/clock.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define PUBSUB_HAS_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define PUBSUB_HAS_RDTSC 1
+#endif
+
+namespace pubsub {
+
+namespace {
+
+constexpr int64_t kInitialCalibrationNs = 1000000;     // 1 ms
+constexpr int64_t kMinRefineIntervalNs = 10000000;     // 10 ms
+constexpr int64_t kMaxRefineIntervalNs = 60000000000;  // 60 s
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t system_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool has_invariant_tsc() {
+#if defined(PUBSUB_HAS_RDTSC) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007u) {
+        return false;
+    }
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#elif defined(PUBSUB_HAS_RDTSC)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+uint64_t read_tsc() {
+#if defined(PUBSUB_HAS_RDTSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Mapping from ticks to the steady and system clocks
+ *
+ * The origin is fixed at startup; only the rate and the wall clock offset
+ * change, each as a single atomic, so readers never see a torn mapping.
+ */
+struct Calibration {
+    Calibration()
+        : tsc(has_invariant_tsc()) {
+        // The first clock reads fault in the vDSO page; keep that out of the origin sample
+        steady_ns();
+        system_ns();
+        read();
+        
+        sample(origin_ticks, origin_steady_ns);
+        system_offset_ns = system_ns() - steady_ns();
+        
+        // A short first measurement; refine() lengthens the baseline later
+        if (tsc) {
+            uint64_t ticks = 0;
+            int64_t steady = 0;
+            do {
+                sample(ticks, steady);
+            } while (steady - origin_steady_ns < kInitialCalibrationNs);
+            ns_per_tick = static_cast<double>(steady - origin_steady_ns) /
+                          static_cast<double>(ticks - origin_ticks);
+        }
+        
+        schedule_refine(origin_ticks, kMinRefineIntervalNs);
+    }
+    
+    uint64_t read() const {
+        return tsc ? read_tsc() : static_cast<uint64_t>(steady_ns());
+    }
+    
+    // Bracket the steady clock read with two tick reads and take the midpoint
+    void sample(uint64_t& ticks, int64_t& steady) const {
+        if (!tsc) {
+            steady = steady_ns();
+            ticks = static_cast<uint64_t>(steady);
+            return;
+        }
+        uint64_t before = read_tsc();
+        steady = steady_ns();
+        uint64_t after = read_tsc();
+        ticks = before + (after - before) / 2;
+    }
+    
+    void refine() {
+        std::lock_guard<std::mutex> lock(refine_mutex);
+        
+        uint64_t ticks = 0;
+        int64_t steady = 0;
+        sample(ticks, steady);
+        
+        if (tsc && ticks > origin_ticks) {
+            ns_per_tick = static_cast<double>(steady - origin_steady_ns) /
+                          static_cast<double>(ticks - origin_ticks);
+        }
+        system_offset_ns = system_ns() - steady_ns();
+        
+        // Refine again once the baseline has doubled, at most once a minute
+        schedule_refine(ticks, std::clamp(steady - origin_steady_ns, kMinRefineIntervalNs, kMaxRefineIntervalNs));
+    }
+    
+    // The deadline is kept in ticks so checking it costs one RDTSC
+    void schedule_refine(uint64_t from_ticks, int64_t interval_ns) {
+        double rate = ns_per_tick.load(std::memory_order_relaxed);
+        next_refine_ticks = from_ticks + static_cast<uint64_t>(static_cast<double>(interval_ns) / rate);
+    }
+    
+    void maybe_refine() {
+        if (read() >= next_refine_ticks.load(std::memory_order_relaxed)) {
+            refine();
+        }
+    }
+    
+    const bool tsc;
+    uint64_t origin_ticks = 0;
+    int64_t origin_steady_ns = 0;
+    std::atomic<double> ns_per_tick{1.0};
+    std::atomic<int64_t> system_offset_ns{0};
+    std::atomic<uint64_t> next_refine_ticks{0};
+    std::mutex refine_mutex;
+};
+
+Calibration& calibration() {
+    static Calibration instance;
+    return instance;
+}
+
+} // namespace
+
+uint64_t TickClock::now() {
+    return calibration().read();
+}
+
+bool TickClock::uses_tsc() {
+    return calibration().tsc;
+}
+
+std::chrono::nanoseconds TickClock::to_duration(int64_t ticks) {
+    auto& cal = calibration();
+    cal.maybe_refine();
+    
+    double rate = cal.ns_per_tick.load(std::memory_order_relaxed);
+    return std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(ticks) * rate));
+}
+
+std::chrono::steady_clock::time_point TickClock::to_steady(uint64_t ticks) {
+    auto& cal = calibration();
+    auto offset = to_duration(static_cast<int64_t>(ticks - cal.origin_ticks));
+    return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds(cal.origin_steady_ns) + offset));
+}
+
+std::chrono::system_clock::time_point TickClock::to_system(uint64_t ticks) {
+    auto& cal = calibration();
+    auto steady = to_steady(ticks).time_since_epoch();
+    auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(steady) +
+                std::chrono::nanoseconds(cal.system_offset_ns.load(std::memory_order_relaxed));
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(wall));
+}
+
+uint64_t TickClock::from_system(std::chrono::system_clock::time_point time) {
+    auto& cal = calibration();
+    cal.maybe_refine();
+    
+    int64_t wall = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    int64_t steady = wall - cal.system_offset_ns.load(std::memory_order_relaxed);
+    double rate = cal.ns_per_tick.load(std::memory_order_relaxed);
+    
+    auto delta = static_cast<int64_t>(static_cast<double>(steady - cal.origin_steady_ns) / rate);
+    return cal.origin_ticks + static_cast<uint64_t>(delta);
+}
+
+void TickClock::recalibrate() {
+    calibration().refine();
+}
+
+} // namespace pubsub
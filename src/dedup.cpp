@@ -0,0 +1,181 @@
+#include "pubsub/dedup.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace pubsub {
+
+namespace {
+
+size_t next_power_of_two(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+uint64_t mix(uint64_t value) {
+    // splitmix64 finalizer to spread std::hash output over all bits
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+} // namespace
+
+DuplicateFilter::DuplicateFilter(size_t window_size, uint64_t window_ms)
+    : generation_limit_(std::max<size_t>(1, (window_size + kGenerations - 2) / (kGenerations - 1)))
+    , mask_(next_power_of_two(generation_limit_ * 2) - 1)
+    , generation_age_(std::chrono::milliseconds(window_ms / (kGenerations - 1)))
+    , time_bounded_(window_ms > 0) {
+
+    // Keep each table at most half full so probe sequences stay short
+    auto now = Clock::now();
+    for (auto& generation : generations_) {
+        generation.slots.assign(mask_ + 1, 0);
+        generation.epochs.assign(mask_ + 1, 0);
+        generation.started = now;
+    }
+
+    if (time_bounded_ && generation_age_.count() == 0) {
+        generation_age_ = std::chrono::milliseconds(1);
+    }
+}
+
+bool DuplicateFilter::check_and_insert(std::string_view key, std::string_view scope) {
+    uint64_t fp = fingerprint(key, scope);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (time_bounded_) {
+        auto now = Clock::now();
+        auto elapsed = now - generations_[current_].started;
+        if (elapsed >= generation_age_) {
+            // Rotate once per elapsed slice so idle periods expire old keys too
+            auto slices = static_cast<size_t>(elapsed / generation_age_);
+            for (size_t i = 0; i < std::min(slices, kGenerations); ++i) {
+                rotate(now);
+            }
+        }
+    }
+
+    for (const auto& generation : generations_) {
+        if (generation.count > 0 && contains(generation, fp)) {
+            return true;
+        }
+    }
+
+    if (generations_[current_].count >= generation_limit_) {
+        rotate(time_bounded_ ? Clock::now() : Clock::time_point{});
+    }
+
+    insert(generations_[current_], fp);
+    return false;
+}
+
+bool DuplicateFilter::erase(std::string_view key, std::string_view scope) {
+    uint64_t fp = fingerprint(key, scope);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    bool erased = false;
+    for (auto& generation : generations_) {
+        while (generation.count > 0 && remove(generation, fp)) {
+            erased = true;
+        }
+    }
+    return erased;
+}
+
+void DuplicateFilter::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto now = Clock::now();
+    for (auto& generation : generations_) {
+        reset(generation, now);
+    }
+    current_ = 0;
+}
+
+size_t DuplicateFilter::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t total = 0;
+    for (const auto& generation : generations_) {
+        total += generation.count;
+    }
+    return total;
+}
+
+uint64_t DuplicateFilter::fingerprint(std::string_view key, std::string_view scope) {
+    uint64_t fp = mix(std::hash<std::string_view>{}(key));
+    if (!scope.empty()) {
+        fp = mix(fp ^ std::hash<std::string_view>{}(scope));
+    }
+    // Zero marks an empty slot
+    return fp == 0 ? 1 : fp;
+}
+
+bool DuplicateFilter::contains(const Generation& generation, uint64_t fp) const {
+    for (size_t i = fp & mask_; generation.epochs[i] == generation.epoch; i = (i + 1) & mask_) {
+        if (generation.slots[i] == fp) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DuplicateFilter::insert(Generation& generation, uint64_t fp) {
+    for (size_t i = fp & mask_;; i = (i + 1) & mask_) {
+        if (generation.epochs[i] != generation.epoch) {
+            generation.slots[i] = fp;
+            generation.epochs[i] = generation.epoch;
+            generation.count++;
+            return;
+        }
+    }
+}
+
+bool DuplicateFilter::remove(Generation& generation, uint64_t fp) {
+    size_t hole = fp & mask_;
+    while (generation.epochs[hole] == generation.epoch && generation.slots[hole] != fp) {
+        hole = (hole + 1) & mask_;
+    }
+    if (generation.epochs[hole] != generation.epoch) {
+        return false;
+    }
+
+    // Backward-shift deletion keeps later probe sequences intact
+    for (size_t next = (hole + 1) & mask_; generation.epochs[next] == generation.epoch; next = (next + 1) & mask_) {
+        size_t home = generation.slots[next] & mask_;
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            generation.slots[hole] = generation.slots[next];
+            hole = next;
+        }
+    }
+    generation.epochs[hole] = 0;
+    generation.count--;
+    return true;
+}
+
+void DuplicateFilter::reset(Generation& generation, Clock::time_point now) {
+    // Bumping the epoch invalidates every slot at once; only a wrap needs a sweep
+    if (++generation.epoch == 0) {
+        std::fill(generation.epochs.begin(), generation.epochs.end(), 0);
+        generation.epoch = 1;
+    }
+    generation.count = 0;
+    generation.started = now;
+}
+
+void DuplicateFilter::rotate(Clock::time_point now) {
+    current_ = (current_ + 1) % kGenerations;
+    reset(generations_[current_], now);
+}
+
+} // namespace pubsub
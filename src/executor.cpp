@@ -0,0 +1,152 @@
+#include "pubsub/executor.hpp"
+
+namespace pubsub {
+
+// InlineExecutor implementation
+bool InlineExecutor::execute(Task task) {
+    task();
+    return true;
+}
+
+// ThreadPoolExecutor implementation
+ThreadPoolExecutor::ThreadPoolExecutor(size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+        if (thread_count == 0) {
+            thread_count = 1;
+        }
+    }
+    
+    threads_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back([this]() {
+            worker_thread();
+        });
+    }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+    shutdown();
+}
+
+bool ThreadPoolExecutor::execute(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void ThreadPoolExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+size_t ThreadPoolExecutor::thread_count() const {
+    return threads_.size();
+}
+
+void ThreadPoolExecutor::worker_thread() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() {
+                return stopping_ || !tasks_.empty();
+            });
+            
+            if (tasks_.empty()) {
+                return;
+            }
+            
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        
+        task();
+    }
+}
+
+// EventLoopExecutor implementation
+EventLoopExecutor::EventLoopExecutor(std::function<void()> wakeup)
+    : wakeup_(std::move(wakeup)) {
+}
+
+bool EventLoopExecutor::execute(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) {
+            return false;
+        }
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    
+    if (wakeup_) {
+        wakeup_();
+    }
+    return true;
+}
+
+size_t EventLoopExecutor::run_pending() {
+    std::deque<Task> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(tasks_);
+    }
+    
+    for (auto& task : batch) {
+        task();
+    }
+    
+    return batch.size();
+}
+
+void EventLoopExecutor::run() {
+    // Tasks accepted before stop() still run, as in ThreadPoolExecutor::shutdown()
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cv_.wait(lock, [this]() {
+            return stopped_ || !tasks_.empty();
+        });
+        
+        if (tasks_.empty()) {
+            return;
+        }
+        
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+        
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+void EventLoopExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    cv_.notify_all();
+}
+
+void EventLoopExecutor::restart() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = false;
+}
+
+} // namespace pubsub
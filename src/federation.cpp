@@ -0,0 +1,162 @@
+#include "pubsub/federation.hpp"
+
+#include <algorithm>
+
+namespace pubsub {
+
+namespace {
+
+std::vector<std::string_view> split_levels(std::string_view pattern) {
+    std::vector<std::string_view> levels;
+    size_t start = 0;
+    for (;;) {
+        size_t slash = pattern.find('/', start);
+        if (slash == std::string_view::npos) {
+            levels.push_back(pattern.substr(start));
+            return levels;
+        }
+        levels.push_back(pattern.substr(start, slash - start));
+        start = slash + 1;
+    }
+}
+
+bool has_wildcard(std::string_view level) {
+    return level.find_first_of("+#") != std::string_view::npos;
+}
+
+// Wildcards occupy whole levels and '#' only appears last
+bool is_level_aligned(const std::vector<std::string_view>& levels) {
+    for (size_t i = 0; i < levels.size(); ++i) {
+        if (levels[i] == "#") {
+            if (i + 1 != levels.size()) {
+                return false;
+            }
+        } else if (levels[i] != "+" && has_wildcard(levels[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// InterestSet implementation
+bool InterestSet::covers(std::string_view general, std::string_view specific) {
+    if (general == specific) {
+        return true;
+    }
+    
+    auto outer = split_levels(general);
+    if (!is_level_aligned(outer)) {
+        return false;
+    }
+    auto inner = split_levels(specific);
+    
+    for (size_t i = 0; i < outer.size(); ++i) {
+        // '#' alone matches everything, "a/#" needs something after "a/"
+        if (outer[i] == "#") {
+            return i == 0 || i < inner.size();
+        }
+        if (i >= inner.size()) {
+            return false;
+        }
+        if (outer[i] == "+") {
+            // A '#' inside the specific level could span several levels
+            if (inner[i].empty() || inner[i].find('#') != std::string_view::npos) {
+                return false;
+            }
+        } else if (outer[i] != inner[i]) {
+            return false;
+        }
+    }
+    
+    return outer.size() == inner.size();
+}
+
+InterestChange InterestSet::add(const std::string& pattern) {
+    InterestChange change;
+    
+    if (counts_[pattern]++ > 0) {
+        return change;
+    }
+    
+    for (const auto& advertised : cover_) {
+        if (covers(advertised, pattern)) {
+            return change;
+        }
+    }
+    
+    // The new pattern supersedes the advertised patterns it covers
+    for (auto it = cover_.begin(); it != cover_.end();) {
+        if (covers(pattern, *it)) {
+            change.removed.push_back(*it);
+            it = cover_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    cover_.insert(pattern);
+    change.added.push_back(pattern);
+    
+    return change;
+}
+
+InterestChange InterestSet::remove(const std::string& pattern) {
+    InterestChange change;
+    
+    auto it = counts_.find(pattern);
+    if (it == counts_.end()) {
+        return change;
+    }
+    if (--it->second > 0) {
+        return change;
+    }
+    counts_.erase(it);
+    
+    if (cover_.erase(pattern) == 0) {
+        return change;
+    }
+    change.removed.push_back(pattern);
+    
+    // Patterns hidden behind the removed one and nothing else become visible
+    std::vector<std::string> uncovered;
+    for (const auto& [candidate, count] : counts_) {
+        if (!covers(pattern, candidate)) {
+            continue;
+        }
+        bool hidden = std::any_of(cover_.begin(), cover_.end(), [&candidate](const std::string& advertised) {
+            return covers(advertised, candidate);
+        });
+        if (!hidden) {
+            uncovered.push_back(candidate);
+        }
+    }
+    
+    // Patterns covering each other are broken by name so the result is deterministic
+    for (const auto& candidate : uncovered) {
+        bool superseded = std::any_of(uncovered.begin(), uncovered.end(), [&candidate](const std::string& other) {
+            return other != candidate && covers(other, candidate) &&
+                   (!covers(candidate, other) || other < candidate);
+        });
+        if (!superseded) {
+            cover_.insert(candidate);
+            change.added.push_back(candidate);
+        }
+    }
+    
+    return change;
+}
+
+std::vector<std::string> InterestSet::patterns() const {
+    std::vector<std::string> result(cover_.begin(), cover_.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void InterestSet::clear() {
+    counts_.clear();
+    cover_.clear();
+}
+
+} // namespace pubsub
@@ -0,0 +1,211 @@
+#include "pubsub/memory.hpp"
+
+#include <cstdint>
+#include <new>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#endif
+
+namespace pubsub {
+
+namespace {
+
+size_t round_to_huge_pages(size_t bytes) {
+    constexpr size_t mask = HugePageResource::kHugePageSize - 1;
+    return (bytes + mask) & ~mask;
+}
+
+} // namespace
+
+// HugePageResource implementation
+HugePageResource::HugePageResource(HugePageMode mode)
+    : mode_(mode) {
+}
+
+HugePageMode HugePageResource::mode() const {
+    return mode_;
+}
+
+size_t HugePageResource::mapped_bytes() const {
+    return mapped_bytes_.load();
+}
+
+size_t HugePageResource::explicit_bytes() const {
+    return explicit_bytes_.load();
+}
+
+size_t HugePageResource::transparent_bytes() const {
+    return transparent_bytes_.load();
+}
+
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment) {
+    if (alignment > kHugePageSize) {
+        throw std::bad_alloc();
+    }
+    
+    size_t length = round_to_huge_pages(bytes == 0 ? 1 : bytes);
+
+#if defined(_WIN32)
+    // Large pages need SeLockMemoryPrivilege; normal heap pages keep the layout
+    void* p = std::pmr::new_delete_resource()->allocate(length, kHugePageSize);
+    mapped_bytes_ += length;
+    return p;
+#else
+#ifdef MAP_HUGETLB
+    if (mode_ == HugePageMode::Explicit) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            {
+                std::lock_guard<std::mutex> lock(regions_mutex_);
+                regions_[p] = true;
+            }
+            mapped_bytes_ += length;
+            explicit_bytes_ += length;
+            return p;
+        }
+    }
+#endif
+    
+    if (mode_ == HugePageMode::Disabled) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        mapped_bytes_ += length;
+        return p;
+    }
+    
+    // Over-map by one huge page so the region can be trimmed to a 2 MB
+    // boundary; the kernel only backs aligned ranges with huge pages
+    size_t padded = length + kHugePageSize;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    
+    auto base = reinterpret_cast<uintptr_t>(raw);
+    auto aligned = round_to_huge_pages(base);
+    size_t head = aligned - base;
+    size_t tail = padded - head - length;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + length), tail);
+    }
+    
+    void* p = reinterpret_cast<void*>(aligned);
+    mapped_bytes_ += length;
+#ifdef MADV_HUGEPAGE
+    if (madvise(p, length, MADV_HUGEPAGE) == 0) {
+        std::lock_guard<std::mutex> lock(regions_mutex_);
+        regions_[p] = false;
+        transparent_bytes_ += length;
+    }
+#endif
+    return p;
+#endif
+}
+
+void HugePageResource::do_deallocate(void* p, size_t bytes, size_t /* alignment */) {
+    size_t length = round_to_huge_pages(bytes == 0 ? 1 : bytes);
+    
+    {
+        std::lock_guard<std::mutex> lock(regions_mutex_);
+        auto it = regions_.find(p);
+        if (it != regions_.end()) {
+            if (it->second) {
+                explicit_bytes_ -= length;
+            } else {
+                transparent_bytes_ -= length;
+            }
+            regions_.erase(it);
+        }
+    }
+    
+#if defined(_WIN32)
+    std::pmr::new_delete_resource()->deallocate(p, length, kHugePageSize);
+#else
+    munmap(p, length);
+#endif
+    mapped_bytes_ -= length;
+}
+
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+namespace detail {
+
+// PageCarver implementation
+PageCarver::PageCarver(HugePageResource& pages)
+    : pages_(pages) {
+}
+
+PageCarver::~PageCarver() {
+    for (void* region : regions_) {
+        pages_.deallocate(region, HugePageResource::kHugePageSize);
+    }
+}
+
+void* PageCarver::do_allocate(size_t bytes, size_t alignment) {
+    if (bytes >= HugePageResource::kHugePageSize / 2) {
+        return pages_.allocate(bytes, alignment);
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(cursor_) % alignment) % alignment;
+    if (!cursor_ || padding + bytes > remaining_) {
+        void* region = pages_.allocate(HugePageResource::kHugePageSize);
+        regions_.push_back(region);
+        cursor_ = static_cast<char*>(region);
+        remaining_ = HugePageResource::kHugePageSize;
+        padding = 0;
+    }
+    
+    void* p = cursor_ + padding;
+    cursor_ += padding + bytes;
+    remaining_ -= padding + bytes;
+    return p;
+}
+
+void PageCarver::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    // Carved blocks stay until destruction
+    if (bytes >= HugePageResource::kHugePageSize / 2) {
+        pages_.deallocate(p, bytes, alignment);
+    }
+}
+
+bool PageCarver::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace detail
+
+// HugePageArena implementation
+HugePageArena::HugePageArena(HugePageMode mode)
+    : pages_(mode)
+    , carver_(pages_)
+    , pool_(&carver_) {
+}
+
+const HugePageResource& HugePageArena::pages() const {
+    return pages_;
+}
+
+void* HugePageArena::do_allocate(size_t bytes, size_t alignment) {
+    return pool_.allocate(bytes, alignment);
+}
+
+void HugePageArena::do_deallocate(void* p, size_t bytes, size_t alignment) {
+    pool_.deallocate(p, bytes, alignment);
+}
+
+bool HugePageArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace pubsub
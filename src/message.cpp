@@ -1,37 +1,87 @@
 #include "pubsub/message.hpp"
+#include "pubsub/clock.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <random>
-#include <sstream>
-#include <iomanip>
+#include <mutex>
 
 namespace pubsub {
 
+namespace detail {
+
+/**
+ * @brief Serialized payload and its lazily decoded value
+ */
+struct EncodedPayload {
+    Buffer bytes;
+    std::shared_ptr<const MessageSerializer> serializer;
+    std::once_flag decode_once;
+    std::any value;
+};
+
+} // namespace detail
+
+Buffer MessageSerializer::serialize_buffer(const std::any& data) const {
+    if (const auto* buffer = std::any_cast<Buffer>(&data)) {
+        return *buffer;
+    }
+    if (const auto* chain = std::any_cast<BufferChain>(&data)) {
+        return chain->flatten();
+    }
+    return Buffer::adopt(serialize(data));
+}
+
+BufferChain MessageSerializer::serialize_chain(const std::any& data) const {
+    if (const auto* chain = std::any_cast<BufferChain>(&data)) {
+        return *chain;
+    }
+    BufferChain chain;
+    chain.append(serialize_buffer(data));
+    return chain;
+}
+
+std::any MessageSerializer::deserialize_buffer(const Buffer& data) const {
+    return deserialize(data.to_vector());
+}
+
+// Resource used by Message::create()
+static std::atomic<std::pmr::memory_resource*> message_resource{nullptr};
+
 // Helper function to generate a unique ID
-static std::string generate_id() {
-    // Use high-resolution clock for timestamp part
-    auto now = std::chrono::high_resolution_clock::now();
-    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        now.time_since_epoch()).count();
+static std::string generate_id(uint64_t ticks) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
     
-    // Add some randomness
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint32_t> dist(0, 0xFFFFFFFF);
-    uint32_t random = dist(gen);
+    // Per-thread generator: seeding from random_device on every message is a syscall
+    thread_local std::mt19937_64 gen(std::random_device{}() ^ ticks);
+    uint32_t random = static_cast<uint32_t>(gen());
     
-    // Format as hex string
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0') << std::setw(16) << timestamp;
-    ss << std::setw(8) << random;
+    // 16 hex digits of tick count followed by 8 random hex digits
+    std::string id(24, '0');
+    for (int i = 15; i >= 0; --i) {
+        id[i] = kHexDigits[ticks & 0xF];
+        ticks >>= 4;
+    }
+    for (int i = 23; i >= 16; --i) {
+        id[i] = kHexDigits[random & 0xF];
+        random >>= 4;
+    }
     
-    return ss.str();
+    return id;
+}
+
+void Message::set_memory_resource(std::pmr::memory_resource* resource) {
+    message_resource.store(resource, std::memory_order_release);
+}
+
+std::pmr::memory_resource* Message::memory_resource() {
+    return message_resource.load(std::memory_order_acquire);
 }
 
 Message::Message(std::string_view topic)
-    : id_(generate_id())
+    : timestamp_ticks_(TickClock::now())
+    , id_(generate_id(timestamp_ticks_))
     , topic_(topic)
-    , timestamp_(std::chrono::system_clock::now())
     , priority_(Priority::Normal) {
 }
 
@@ -44,7 +94,18 @@ const std::string& Message::topic() const {
 }
 
 Message::TimePoint Message::timestamp() const {
-    return timestamp_;
+    // The first conversion wins, so a later calibration cannot move the timestamp
+    int64_t ns = timestamp_ns_.ns.load(std::memory_order_relaxed);
+    if (ns == detail::CachedTimestamp::kUnset) {
+        int64_t converted = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            TickClock::to_system(timestamp_ticks_).time_since_epoch()).count();
+        ns = timestamp_ns_.ns.compare_exchange_strong(ns, converted, std::memory_order_relaxed) ? converted : ns;
+    }
+    return TimePoint(std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds(ns)));
+}
+
+uint64_t Message::timestamp_ticks() const {
+    return timestamp_ticks_;
 }
 
 Priority Message::priority() const {
@@ -75,10 +136,64 @@ std::string Message::get_header(const std::string& key, const std::string& defau
     return default_value;
 }
 
+void Message::set_encoded_payload(Buffer bytes, std::shared_ptr<const MessageSerializer> serializer) {
+    payload_size_ = bytes.size();
+    payload_.reset();
+    
+    encoded_ = std::make_shared<detail::EncodedPayload>();
+    encoded_->bytes = std::move(bytes);
+    encoded_->serializer = std::move(serializer);
+}
+
+bool Message::has_encoded_payload() const {
+    return encoded_ != nullptr;
+}
+
+const Buffer& Message::encoded_payload() const {
+    static const Buffer empty;
+    return encoded_ ? encoded_->bytes : empty;
+}
+
+const std::any& Message::decoded_payload() const {
+    if (!encoded_) {
+        return payload_;
+    }
+    
+    // A throwing serializer leaves the flag unset, so a later access retries
+    auto& encoded = *encoded_;
+    std::call_once(encoded.decode_once, [&encoded]() {
+        if (encoded.serializer) {
+            encoded.value = encoded.serializer->deserialize_buffer(encoded.bytes);
+        } else {
+            encoded.value = encoded.bytes;
+        }
+    });
+    return encoded.value;
+}
+
+size_t Message::payload_size() const {
+    return payload_size_;
+}
+
+void Message::set_payload_size(size_t bytes) {
+    payload_size_ = bytes;
+}
+
+size_t Message::approximate_size() const {
+    size_t size = sizeof(Message) + id_.size() + topic_.size() + payload_size_;
+    for (const auto& [key, value] : headers_) {
+        size += key.size() + value.size() + 2 * sizeof(std::string);
+    }
+    return size;
+}
+
 std::vector<uint8_t> Message::serialize(const MessageSerializer& serializer) const {
     // This is a simplified implementation
     // In a real-world scenario, we would serialize all message properties
-    return serializer.serialize(payload_);
+    if (encoded_ && encoded_->serializer.get() == &serializer) {
+        return encoded_->bytes.to_vector();
+    }
+    return serializer.serialize(decoded_payload());
 }
 
 std::shared_ptr<Message> Message::deserialize(
@@ -92,6 +207,54 @@ std::shared_ptr<Message> Message::deserialize(
     // For now, we just create a dummy message
     auto msg = std::make_shared<Message>("deserialized");
     msg->payload_ = payload;
+    msg->payload_size_ = data.size();
+    
+    return msg;
+}
+
+std::shared_ptr<Message> Message::deserialize(
+    const std::vector<uint8_t>& data, 
+    std::shared_ptr<const MessageSerializer> serializer) {
+    
+    return deserialize(Buffer::copy(data.data(), data.size()), std::move(serializer));
+}
+
+Buffer Message::serialize_buffer(const MessageSerializer& serializer) const {
+    // Forward the original bytes instead of decoding and re-encoding them
+    if (encoded_ && encoded_->serializer.get() == &serializer) {
+        return encoded_->bytes;
+    }
+    return serializer.serialize_buffer(decoded_payload());
+}
+
+BufferChain Message::serialize_chain(const MessageSerializer& serializer) const {
+    if (encoded_ && encoded_->serializer.get() == &serializer) {
+        BufferChain chain;
+        chain.append(encoded_->bytes);
+        return chain;
+    }
+    return serializer.serialize_chain(decoded_payload());
+}
+
+std::shared_ptr<Message> Message::deserialize(
+    const Buffer& data,
+    const MessageSerializer& serializer) {
+    
+    auto msg = std::make_shared<Message>("deserialized");
+    msg->payload_ = serializer.deserialize_buffer(data);
+    msg->payload_size_ = data.size();
+    
+    return msg;
+}
+
+std::shared_ptr<Message> Message::deserialize(
+    const Buffer& data,
+    std::shared_ptr<const MessageSerializer> serializer) {
+    
+    // This is a simplified implementation
+    // In a real-world scenario, we would deserialize all message properties
+    auto msg = std::make_shared<Message>("deserialized");
+    msg->set_encoded_payload(data, std::move(serializer));
     
     return msg;
 }
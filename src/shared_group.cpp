@@ -0,0 +1,142 @@
+#include "pubsub/shared_group.hpp"
+#include "pubsub/message.hpp"
+#include "pubsub/topic.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace pubsub {
+
+SubscriptionGroup::SubscriptionGroup(
+    std::string name,
+    std::shared_ptr<TopicFilter> filter,
+    ShareStrategy strategy,
+    std::string key_header)
+    : name_(std::move(name))
+    , filter_(std::move(filter))
+    , strategy_(strategy)
+    , key_header_(std::move(key_header)) {
+}
+
+bool SubscriptionGroup::is_shared_pattern(std::string_view pattern) {
+    return pattern.substr(0, kSharePrefix.size()) == kSharePrefix;
+}
+
+bool SubscriptionGroup::parse(std::string_view pattern, std::string& group, std::string& filter) {
+    if (!is_shared_pattern(pattern)) {
+        return false;
+    }
+
+    std::string_view rest = pattern.substr(kSharePrefix.size());
+    size_t slash = rest.find('/');
+    if (slash == std::string_view::npos || slash == 0 || slash + 1 == rest.size()) {
+        return false;
+    }
+
+    std::string_view name = rest.substr(0, slash);
+    if (TopicFilterFactory::has_wildcards(name)) {
+        return false;
+    }
+
+    group = std::string(name);
+    filter = std::string(rest.substr(slash + 1));
+    return true;
+}
+
+std::string SubscriptionGroup::make_key(std::string_view group, std::string_view filter) {
+    std::string key;
+    key.reserve(group.size() + filter.size() + 1);
+    key += group;
+    key += '/';
+    key += filter;
+    return key;
+}
+
+const std::string& SubscriptionGroup::name() const {
+    return name_;
+}
+
+bool SubscriptionGroup::matches(std::string_view topic) const {
+    return filter_->matches(topic);
+}
+
+void SubscriptionGroup::add(std::shared_ptr<Subscription> subscription) {
+    members_.push_back(std::move(subscription));
+}
+
+bool SubscriptionGroup::remove(const std::string& subscription_id) {
+    auto it = std::find_if(members_.begin(), members_.end(),
+        [&subscription_id](const std::shared_ptr<Subscription>& member) {
+            return member->id() == subscription_id;
+        });
+
+    if (it == members_.end()) {
+        return false;
+    }
+
+    members_.erase(it);
+    return true;
+}
+
+size_t SubscriptionGroup::size() const {
+    return members_.size();
+}
+
+bool SubscriptionGroup::empty() const {
+    return members_.empty();
+}
+
+std::shared_ptr<Subscription> SubscriptionGroup::select(const Message& message) {
+    const size_t count = members_.size();
+    if (count == 0) {
+        return nullptr;
+    }
+
+    size_t start = 0;
+    switch (strategy_) {
+        case ShareStrategy::RoundRobin:
+            start = cursor_.fetch_add(1, std::memory_order_relaxed) % count;
+            break;
+
+        case ShareStrategy::LeastLoaded: {
+            // Fewest in-flight callbacks wins; ties rotate so idle members share work
+            size_t offset = cursor_.fetch_add(1, std::memory_order_relaxed);
+            std::shared_ptr<Subscription> best;
+            size_t best_load = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const auto& member = members_[(offset + i) % count];
+                if (!member->is_active()) {
+                    continue;
+                }
+                size_t load = member->in_flight();
+                if (!best || load < best_load) {
+                    best = member;
+                    best_load = load;
+                }
+            }
+            return best;
+        }
+
+        case ShareStrategy::KeyHash: {
+            auto it = key_header_.empty() ? message.headers().end()
+                                          : message.headers().find(key_header_);
+            std::string_view key = it != message.headers().end()
+                ? std::string_view(it->second)
+                : std::string_view(message.topic());
+            start = std::hash<std::string_view>{}(key) % count;
+            break;
+        }
+    }
+
+    // Skip cancelled members that have not been unsubscribed yet
+    for (size_t i = 0; i < count; ++i) {
+        const auto& member = members_[(start + i) % count];
+        if (member->is_active()) {
+            return member;
+        }
+    }
+
+    return nullptr;
+}
+
+} // namespace pubsub
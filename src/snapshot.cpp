@@ -0,0 +1,358 @@
+#include "pubsub/snapshot.hpp"
+#include "pubsub/clock.hpp"
+#include "pubsub/message.hpp"
+#include "binary_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pubsub {
+
+using detail::append_bytes;
+using detail::append_string;
+using detail::append_value;
+using detail::read_value;
+using detail::RecordReader;
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'S', 'N', 'A', 'P', '0', '0', '1'};
+
+// magic, topic count, name table offset, index offset
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kIndexEntrySize = 32;
+
+} // namespace
+
+// Snapshot implementation
+std::shared_ptr<Snapshot> Snapshot::open(const std::string& path) {
+    std::shared_ptr<Snapshot> snapshot(new Snapshot());
+
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return nullptr;
+    }
+    snapshot->fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    snapshot->data_ = snapshot->fallback_.data();
+    snapshot->size_ = snapshot->fallback_.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderSize)) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    snapshot->data_ = static_cast<const uint8_t*>(mapped);
+    snapshot->size_ = static_cast<size_t>(st.st_size);
+#endif
+
+    // Validate the header and index bounds before trusting any offsets
+    if (snapshot->size_ < kHeaderSize || std::memcmp(snapshot->data_, kMagic, sizeof(kMagic)) != 0) {
+        return nullptr;
+    }
+
+    uint64_t topic_count = read_value<uint64_t>(snapshot->data_ + 8);
+    uint64_t index_offset = read_value<uint64_t>(snapshot->data_ + 24);
+    if (index_offset > snapshot->size_ ||
+        topic_count > (snapshot->size_ - index_offset) / kIndexEntrySize) {
+        return nullptr;
+    }
+
+    snapshot->topic_count_ = static_cast<size_t>(topic_count);
+    snapshot->index_offset_ = index_offset;
+
+    return snapshot;
+}
+
+Snapshot::~Snapshot() {
+#if !defined(_WIN32)
+    if (data_ && fallback_.empty()) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+}
+
+size_t Snapshot::topic_count() const {
+    return topic_count_;
+}
+
+Snapshot::IndexEntry Snapshot::entry(size_t index) const {
+    const uint8_t* base = data_ + index_offset_ + index * kIndexEntrySize;
+
+    IndexEntry result;
+    result.name_offset = read_value<uint64_t>(base);
+    result.name_length = read_value<uint32_t>(base + 8);
+    result.message_count = read_value<uint32_t>(base + 12);
+    result.data_offset = read_value<uint64_t>(base + 16);
+    result.data_size = read_value<uint64_t>(base + 24);
+
+    // Clamp corrupt entries to empty ranges instead of reading out of bounds
+    if (result.name_offset > size_ || result.name_length > size_ - result.name_offset) {
+        result.name_offset = 0;
+        result.name_length = 0;
+    }
+    if (result.data_offset > size_ || result.data_size > size_ - result.data_offset) {
+        result.data_offset = 0;
+        result.data_size = 0;
+        result.message_count = 0;
+    }
+
+    return result;
+}
+
+std::string_view Snapshot::topic_name(size_t index) const {
+    IndexEntry e = entry(index);
+    return std::string_view(reinterpret_cast<const char*>(data_ + e.name_offset), e.name_length);
+}
+
+bool Snapshot::find(std::string_view topic, size_t& index) const {
+    index = lower_bound(topic);
+    return index < topic_count_ && topic_name(index) == topic;
+}
+
+size_t Snapshot::lower_bound(std::string_view topic) const {
+    size_t low = 0;
+    size_t high = topic_count_;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (topic_name(mid) < topic) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+size_t Snapshot::message_count(size_t index) const {
+    return entry(index).message_count;
+}
+
+std::vector<std::shared_ptr<Message>> Snapshot::load_messages(
+    size_t index,
+    const std::shared_ptr<const MessageSerializer>& serializer) const {
+
+    IndexEntry e = entry(index);
+    std::string topic(topic_name(index));
+    RecordReader reader(data_ + e.data_offset, static_cast<size_t>(e.data_size));
+
+    // Payload buffers keep the mapping alive instead of copying out of it
+    auto self = shared_from_this();
+
+    std::vector<std::shared_ptr<Message>> messages;
+    messages.reserve(e.message_count);
+
+    for (uint32_t i = 0; i < e.message_count; ++i) {
+        auto msg = std::make_shared<Message>(topic);
+
+        int64_t timestamp_ns = 0;
+        uint8_t priority = 0;
+        uint32_t header_count = 0;
+        if (!reader.read_string(msg->id_) ||
+            !reader.read(timestamp_ns) ||
+            !reader.read(priority) ||
+            !reader.read(header_count)) {
+            break;
+        }
+
+        msg->timestamp_ticks_ = TickClock::from_system(Message::TimePoint(
+            std::chrono::duration_cast<Message::TimePoint::duration>(std::chrono::nanoseconds(timestamp_ns))));
+        msg->timestamp_ns_.ns.store(timestamp_ns, std::memory_order_relaxed);
+        msg->priority_ = static_cast<Priority>(std::min<uint8_t>(priority, static_cast<uint8_t>(Priority::Critical)));
+
+        bool ok = true;
+        for (uint32_t h = 0; h < header_count && ok; ++h) {
+            std::string key;
+            std::string value;
+            ok = reader.read_string(key) && reader.read_string(value);
+            if (ok) {
+                msg->headers_.emplace(std::move(key), std::move(value));
+            }
+        }
+
+        uint64_t payload_size = 0;
+        const uint8_t* payload = nullptr;
+        if (!ok || !reader.read(payload_size) || !reader.read_bytes(static_cast<size_t>(payload_size), payload)) {
+            break;
+        }
+
+        Buffer bytes = Buffer::wrap(payload, static_cast<size_t>(payload_size),
+            [self](const uint8_t*, size_t) {});
+
+        if (serializer) {
+            msg->set_encoded_payload(std::move(bytes), serializer);
+        } else {
+            msg->set_payload(std::move(bytes));
+        }
+
+        messages.push_back(std::move(msg));
+    }
+
+    return messages;
+}
+
+// SnapshotWriter implementation
+SnapshotWriter::SnapshotWriter(std::string path, const MessageSerializer* serializer)
+    : path_(std::move(path))
+    , temp_path_(path_ + ".tmp")
+    , serializer_(serializer) {
+
+    file_ = std::fopen(temp_path_.c_str(), "wb");
+    if (!file_) {
+        failed_ = true;
+        return;
+    }
+
+    // Placeholder header, rewritten by finish()
+    uint8_t header[kHeaderSize] = {};
+    write(header, sizeof(header));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (file_) {
+        std::fclose(file_);
+        std::remove(temp_path_.c_str());
+    }
+}
+
+bool SnapshotWriter::is_open() const {
+    return file_ != nullptr && !failed_;
+}
+
+void SnapshotWriter::add_topic(std::string_view name, const std::vector<std::shared_ptr<Message>>& messages) {
+    if (!is_open()) {
+        return;
+    }
+
+    record_.clear();
+    for (const auto& msg : messages) {
+        append_string(record_, msg->id());
+
+        auto timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            msg->timestamp().time_since_epoch()).count();
+        append_value<int64_t>(record_, static_cast<int64_t>(timestamp_ns));
+        append_value<uint8_t>(record_, static_cast<uint8_t>(msg->priority()));
+
+        append_value<uint32_t>(record_, static_cast<uint32_t>(msg->headers().size()));
+        for (const auto& [key, value] : msg->headers()) {
+            append_string(record_, key);
+            append_string(record_, value);
+        }
+
+        BufferChain payload;
+        if (serializer_) {
+            payload = msg->serialize_chain(*serializer_);
+        } else if (msg->has_encoded_payload()) {
+            payload.append(msg->encoded_payload());
+        } else if (msg->has_payload_type<Buffer>()) {
+            payload.append(msg->payload<Buffer>());
+        }
+        append_value<uint64_t>(record_, payload.size());
+        for (const auto& segment : payload.buffers()) {
+            append_bytes(record_, segment.data(), segment.size());
+        }
+    }
+
+    entries_.push_back(PendingEntry{std::string(name), static_cast<uint32_t>(messages.size()),
+                                    offset_, record_.size()});
+    write(record_.data(), record_.size());
+}
+
+void SnapshotWriter::add_topic(const Snapshot& snapshot, size_t index) {
+    if (!is_open()) {
+        return;
+    }
+
+    Snapshot::IndexEntry e = snapshot.entry(index);
+    entries_.push_back(PendingEntry{std::string(snapshot.topic_name(index)), e.message_count,
+                                    offset_, e.data_size});
+    write(snapshot.data_ + e.data_offset, static_cast<size_t>(e.data_size));
+}
+
+bool SnapshotWriter::finish() {
+    if (!is_open()) {
+        return false;
+    }
+
+    std::sort(entries_.begin(), entries_.end(),
+        [](const PendingEntry& a, const PendingEntry& b) { return a.name < b.name; });
+
+    // Name table
+    uint64_t names_offset = offset_;
+    std::vector<uint64_t> name_offsets;
+    name_offsets.reserve(entries_.size());
+    for (const auto& e : entries_) {
+        name_offsets.push_back(offset_);
+        write(e.name.data(), e.name.size());
+    }
+
+    // Sorted index
+    uint64_t index_offset = offset_;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        record_.clear();
+        append_value<uint64_t>(record_, name_offsets[i]);
+        append_value<uint32_t>(record_, static_cast<uint32_t>(entries_[i].name.size()));
+        append_value<uint32_t>(record_, entries_[i].message_count);
+        append_value<uint64_t>(record_, entries_[i].data_offset);
+        append_value<uint64_t>(record_, entries_[i].data_size);
+        write(record_.data(), record_.size());
+    }
+
+    // Final header
+    record_.clear();
+    append_bytes(record_, kMagic, sizeof(kMagic));
+    append_value<uint64_t>(record_, entries_.size());
+    append_value<uint64_t>(record_, names_offset);
+    append_value<uint64_t>(record_, index_offset);
+    if (!failed_ && (std::fseek(file_, 0, SEEK_SET) != 0 ||
+                     std::fwrite(record_.data(), 1, record_.size(), file_) != record_.size())) {
+        failed_ = true;
+    }
+
+    bool ok = std::fclose(file_) == 0 && !failed_;
+    file_ = nullptr;
+
+    if (!ok || std::rename(temp_path_.c_str(), path_.c_str()) != 0) {
+        std::remove(temp_path_.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void SnapshotWriter::write(const void* data, size_t size) {
+    if (failed_ || size == 0) {
+        return;
+    }
+
+    if (std::fwrite(data, 1, size, file_) != size) {
+        failed_ = true;
+        return;
+    }
+
+    offset_ += size;
+}
+
+} // namespace pubsub
@@ -1,28 +1,66 @@
 #include "pubsub/subscription.hpp"
+#include "pubsub/executor.hpp"
 #include "pubsub/message.hpp"
+#include "pubsub/shared_group.hpp"
 #include "pubsub/topic.hpp"
 #include <mutex>
+#include <stdexcept>
 #include <vector>
 
 namespace pubsub {
 
+namespace {
+
+// Shared by every callback flavour so IDs stay unique
+std::atomic<uint64_t> next_subscription_id{0};
+
+} // namespace
+
 std::shared_ptr<Subscription> Subscription::create(
     std::string_view topic_pattern,
     MessageCallback callback,
     const SubscriptionOptions& options) {
     
+    return create_with(topic_pattern, std::move(callback), options);
+}
+
+std::shared_ptr<Subscription> Subscription::create(
+    std::string_view topic_pattern,
+    MessageRefCallback callback,
+    const SubscriptionOptions& options) {
+    
+    return create_with(topic_pattern, std::move(callback), options);
+}
+
+template<typename Callback>
+std::shared_ptr<Subscription> Subscription::create_with(
+    std::string_view topic_pattern,
+    Callback callback,
+    const SubscriptionOptions& options) {
+    
+    // Split off the group name of shared subscriptions
+    std::string group;
+    std::string pattern;
+    if (SubscriptionGroup::is_shared_pattern(topic_pattern)) {
+        if (!SubscriptionGroup::parse(topic_pattern, group, pattern)) {
+            throw std::invalid_argument("Malformed shared subscription pattern");
+        }
+    } else {
+        pattern = std::string(topic_pattern);
+    }
+    
     // Create a topic filter based on the pattern
-    auto filter = TopicFilterFactory::create(std::string(topic_pattern));
+    auto filter = TopicFilterFactory::create(std::move(pattern));
     
     // Generate a unique ID
-    static std::atomic<uint64_t> next_id{0};
-    std::string id = "sub_" + std::to_string(next_id++);
+    std::string id = "sub_" + std::to_string(next_subscription_id++);
     
     return std::make_shared<Subscription>(
         std::move(id),
         std::move(filter),
         std::move(callback),
-        options
+        options,
+        std::move(group)
     );
 }
 
@@ -30,11 +68,28 @@ Subscription::Subscription(
     std::string id,
     std::shared_ptr<TopicFilter> filter,
     MessageCallback callback,
-    SubscriptionOptions options)
+    SubscriptionOptions options,
+    std::string share_group)
     : id_(std::move(id))
     , filter_(std::move(filter))
     , callback_(std::move(callback))
     , options_(std::move(options))
+    , share_group_(std::move(share_group))
+    , message_count_(0)
+    , active_(true) {
+}
+
+Subscription::Subscription(
+    std::string id,
+    std::shared_ptr<TopicFilter> filter,
+    MessageRefCallback callback,
+    SubscriptionOptions options,
+    std::string share_group)
+    : id_(std::move(id))
+    , filter_(std::move(filter))
+    , ref_callback_(std::move(callback))
+    , options_(std::move(options))
+    , share_group_(std::move(share_group))
     , message_count_(0)
     , active_(true) {
 }
@@ -47,21 +102,37 @@ const std::shared_ptr<TopicFilter>& Subscription::filter() const {
     return filter_;
 }
 
+const SubscriptionOptions& Subscription::options() const {
+    return options_;
+}
+
+const std::string& Subscription::share_group() const {
+    return share_group_;
+}
+
+bool Subscription::is_shared() const {
+    return !share_group_.empty();
+}
+
 bool Subscription::matches(std::string_view topic) const {
     return filter_->matches(topic);
 }
 
-DeliveryResult Subscription::deliver(std::shared_ptr<Message> message) {
+DeliveryResult Subscription::deliver(const std::shared_ptr<Message>& message) {
+    // Check if the message topic matches the subscription filter
+    if (is_active() && !matches(message->topic())) {
+        return DeliveryResult::Filtered;
+    }
+    
+    return dispatch(message);
+}
+
+DeliveryResult Subscription::dispatch(const std::shared_ptr<Message>& message) {
     // Check if subscription is active
     if (!is_active()) {
         return DeliveryResult::Rejected;
     }
     
-    // Check if the message topic matches the subscription filter
-    if (!matches(message->topic())) {
-        return DeliveryResult::Filtered;
-    }
-    
     // Check if we've reached the maximum number of messages
     if (options_.max_messages > 0 && message_count_.load() >= options_.max_messages) {
         return DeliveryResult::Rejected;
@@ -69,10 +140,49 @@ DeliveryResult Subscription::deliver(std::shared_ptr<Message> message) {
     
     // Increment message count
     message_count_++;
+    in_flight_++;
+    
+    // Serialize through the strand; whoever finds it idle runs the queued callbacks
+    if (options_.strand) {
+        // Count the push once the node is linked, then try to claim (pairs with drain_strand())
+        strand_queue_.push(message);
+        strand_pushed_.fetch_add(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!strand_claimed_.exchange(true, std::memory_order_acquire)) {
+            // Queued callbacks cannot be taken back, so a rejected drain runs here
+            bool scheduled = options_.executor && options_.executor->execute([self = shared_from_this()]() {
+                self->drain_strand();
+            });
+            if (!scheduled) {
+                drain_strand();
+            }
+        }
+        return DeliveryResult::Success;
+    }
     
-    // Deliver the message to the callback
+    // Hand the callback to the subscriber's executor; the task keeps the message alive
+    if (options_.executor) {
+        if (!options_.executor->execute([self = shared_from_this(), message]() {
+                self->invoke(message);
+            })) {
+            message_count_--;
+            in_flight_--;
+            return DeliveryResult::Rejected;
+        }
+        return DeliveryResult::Success;
+    }
+    
+    return invoke(message);
+}
+
+DeliveryResult Subscription::invoke(const std::shared_ptr<Message>& message) {
     try {
-        callback_(message);
+        if (ref_callback_) {
+            ref_callback_(*message);
+        } else {
+            callback_(message);
+        }
+        in_flight_--;
         
         // Auto-acknowledge if configured
         if (options_.auto_acknowledge) {
@@ -81,10 +191,30 @@ DeliveryResult Subscription::deliver(std::shared_ptr<Message> message) {
         
         return DeliveryResult::Success;
     } catch (...) {
+        in_flight_--;
         return DeliveryResult::Error;
     }
 }
 
+void Subscription::drain_strand() {
+    std::shared_ptr<Message> message;
+    for (;;) {
+        size_t pushed = strand_pushed_.load(std::memory_order_acquire);
+        while (strand_queue_.try_pop(message)) {
+            invoke(message);
+        }
+        
+        // Take the claim back only if a push was linked meanwhile; a producer
+        // still linking its node claims the strand itself once it is done
+        strand_claimed_.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (strand_pushed_.load(std::memory_order_relaxed) == pushed ||
+            strand_claimed_.exchange(true, std::memory_order_acquire)) {
+            return;
+        }
+    }
+}
+
 bool Subscription::acknowledge(const std::string& message_id) {
     // This is a simplified implementation
     // In a real-world scenario, we would track which messages have been acknowledged
@@ -104,4 +234,8 @@ size_t Subscription::message_count() const {
     return message_count_.load();
 }
 
+size_t Subscription::in_flight() const {
+    return in_flight_.load();
+}
+
 } // namespace pubsub 
\ No newline at end of file
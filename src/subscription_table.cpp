@@ -0,0 +1,282 @@
+#include "pubsub/subscription_table.hpp"
+#include "pubsub/subscription.hpp"
+#include "pubsub/topic.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace pubsub {
+
+namespace {
+
+constexpr size_t kInitialSlots = 64;
+constexpr uint32_t kInitialRun = 2;
+
+} // namespace
+
+SubscriptionTable::SubscriptionTable(std::pmr::memory_resource* resource)
+    : slot_hash_(kInitialSlots, 0, resource)
+    , slot_entry_(kInitialSlots, kNone, resource)
+    , entry_topic_(resource)
+    , entry_offset_(resource)
+    , entry_count_(resource)
+    , entry_capacity_(resource)
+    , free_entries_(resource)
+    , members_(resource)
+    , group_filter_(resource)
+    , group_members_(resource)
+    , group_index_(resource) {
+}
+
+uint64_t SubscriptionTable::hash_topic(std::string_view topic) {
+    // splitmix64 finalizer over std::hash; 0 marks an empty slot
+    uint64_t value = std::hash<std::string_view>{}(topic);
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value == 0 ? 1 : value;
+}
+
+void SubscriptionTable::add(const std::shared_ptr<Subscription>& subscription) {
+    size_++;
+    
+    const auto& filter = subscription->filter();
+    if (!dynamic_cast<const ExactTopicFilter*>(filter.get())) {
+        auto it = group_index_.find(filter.get());
+        if (it == group_index_.end()) {
+            it = group_index_.emplace(filter.get(), static_cast<uint32_t>(group_filter_.size())).first;
+            group_filter_.push_back(filter);
+            group_members_.emplace_back(group_members_.get_allocator());
+        }
+        group_members_[it->second].push_back(subscription);
+        return;
+    }
+    
+    std::string_view topic = filter->pattern();
+    uint64_t hash = hash_topic(topic);
+    uint32_t slot = find_slot(hash, topic);
+    uint32_t entry = slot == kNone ? create_entry(hash, topic) : slot_entry_[slot];
+    
+    if (entry_count_[entry] == entry_capacity_[entry]) {
+        reserve_run(entry, entry_capacity_[entry] * 2);
+    }
+    members_[entry_offset_[entry] + entry_count_[entry]++] = subscription;
+}
+
+bool SubscriptionTable::remove(const std::shared_ptr<Subscription>& subscription) {
+    const auto& filter = subscription->filter();
+    if (!dynamic_cast<const ExactTopicFilter*>(filter.get())) {
+        auto it = group_index_.find(filter.get());
+        if (it == group_index_.end()) {
+            return false;
+        }
+        
+        uint32_t group = it->second;
+        auto& members = group_members_[group];
+        auto member = std::find(members.begin(), members.end(), subscription);
+        if (member == members.end()) {
+            return false;
+        }
+        *member = std::move(members.back());
+        members.pop_back();
+        size_--;
+        
+        // Keep the groups dense by moving the last one into the gap
+        if (members.empty()) {
+            group_index_.erase(it);
+            uint32_t last = static_cast<uint32_t>(group_filter_.size() - 1);
+            if (group != last) {
+                group_filter_[group] = std::move(group_filter_[last]);
+                group_members_[group] = std::move(group_members_[last]);
+                group_index_[group_filter_[group].get()] = group;
+            }
+            group_filter_.pop_back();
+            group_members_.pop_back();
+        }
+        return true;
+    }
+    
+    std::string_view topic = filter->pattern();
+    uint32_t slot = find_slot(hash_topic(topic), topic);
+    if (slot == kNone) {
+        return false;
+    }
+    
+    uint32_t entry = slot_entry_[slot];
+    auto begin = members_.begin() + entry_offset_[entry];
+    auto end = begin + entry_count_[entry];
+    auto member = std::find(begin, end, subscription);
+    if (member == end) {
+        return false;
+    }
+    *member = std::move(*(end - 1));
+    (end - 1)->reset();
+    entry_count_[entry]--;
+    size_--;
+    
+    if (entry_count_[entry] == 0) {
+        unused_members_ += entry_capacity_[entry];
+        entry_capacity_[entry] = 0;
+        entry_topic_[entry].clear();
+        free_entries_.push_back(entry);
+        erase_slot(slot);
+        slot_count_--;
+        compact_members();
+    }
+    return true;
+}
+
+void SubscriptionTable::clear() {
+    size_ = 0;
+    slot_hash_.assign(kInitialSlots, 0);
+    slot_entry_.assign(kInitialSlots, kNone);
+    slot_count_ = 0;
+    entry_topic_.clear();
+    entry_offset_.clear();
+    entry_count_.clear();
+    entry_capacity_.clear();
+    free_entries_.clear();
+    members_.clear();
+    unused_members_ = 0;
+    group_filter_.clear();
+    group_members_.clear();
+    group_index_.clear();
+}
+
+void SubscriptionTable::match(std::string_view topic, std::vector<std::shared_ptr<Subscription>>& matching) const {
+    if (slot_count_ > 0) {
+        uint32_t slot = find_slot(hash_topic(topic), topic);
+        if (slot != kNone) {
+            uint32_t entry = slot_entry_[slot];
+            auto begin = members_.begin() + entry_offset_[entry];
+            matching.insert(matching.end(), begin, begin + entry_count_[entry]);
+        }
+    }
+    
+    for (size_t group = 0; group < group_filter_.size(); ++group) {
+        if (group_filter_[group]->matches(topic)) {
+            matching.insert(matching.end(), group_members_[group].begin(), group_members_[group].end());
+        }
+    }
+}
+
+size_t SubscriptionTable::size() const {
+    return size_;
+}
+
+size_t SubscriptionTable::exact_topic_count() const {
+    return slot_count_;
+}
+
+uint32_t SubscriptionTable::find_slot(uint64_t hash, std::string_view topic) const {
+    size_t mask = slot_hash_.size() - 1;
+    for (size_t slot = hash & mask; slot_hash_[slot] != 0; slot = (slot + 1) & mask) {
+        if (slot_hash_[slot] == hash && entry_topic_[slot_entry_[slot]] == topic) {
+            return static_cast<uint32_t>(slot);
+        }
+    }
+    return kNone;
+}
+
+void SubscriptionTable::insert_slot(uint64_t hash, uint32_t entry) {
+    size_t mask = slot_hash_.size() - 1;
+    size_t slot = hash & mask;
+    while (slot_hash_[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    slot_hash_[slot] = hash;
+    slot_entry_[slot] = entry;
+}
+
+void SubscriptionTable::erase_slot(uint32_t slot) {
+    // Backward-shift deletion keeps probe sequences unbroken without tombstones
+    size_t mask = slot_hash_.size() - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; slot_hash_[next] != 0; next = (next + 1) & mask) {
+        size_t home = slot_hash_[next] & mask;
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            slot_hash_[hole] = slot_hash_[next];
+            slot_entry_[hole] = slot_entry_[next];
+            hole = next;
+        }
+    }
+    slot_hash_[hole] = 0;
+    slot_entry_[hole] = kNone;
+}
+
+void SubscriptionTable::grow_slots() {
+    ArenaVector<uint64_t> hashes(slot_hash_.size() * 2, 0, slot_hash_.get_allocator());
+    ArenaVector<uint32_t> entries(slot_entry_.size() * 2, kNone, slot_entry_.get_allocator());
+    slot_hash_.swap(hashes);
+    slot_entry_.swap(entries);
+    
+    for (size_t slot = 0; slot < hashes.size(); ++slot) {
+        if (hashes[slot] != 0) {
+            insert_slot(hashes[slot], entries[slot]);
+        }
+    }
+}
+
+uint32_t SubscriptionTable::create_entry(uint64_t hash, std::string_view topic) {
+    // Stay at most half full so probes end within a cache line or two
+    if ((slot_count_ + 1) * 2 > slot_hash_.size()) {
+        grow_slots();
+    }
+    
+    uint32_t entry;
+    if (!free_entries_.empty()) {
+        entry = free_entries_.back();
+        free_entries_.pop_back();
+        entry_topic_[entry].assign(topic.data(), topic.size());
+        entry_count_[entry] = 0;
+    } else {
+        entry = static_cast<uint32_t>(entry_topic_.size());
+        entry_topic_.emplace_back(topic, entry_topic_.get_allocator());
+        entry_offset_.push_back(0);
+        entry_count_.push_back(0);
+        entry_capacity_.push_back(0);
+    }
+    
+    reserve_run(entry, kInitialRun);
+    insert_slot(hash, entry);
+    slot_count_++;
+    return entry;
+}
+
+void SubscriptionTable::reserve_run(uint32_t entry, uint32_t capacity) {
+    // Runs only grow at the end of the array; the old run becomes unused
+    auto offset = static_cast<uint32_t>(members_.size());
+    members_.resize(members_.size() + capacity);
+    for (uint32_t i = 0; i < entry_count_[entry]; ++i) {
+        members_[offset + i] = std::move(members_[entry_offset_[entry] + i]);
+    }
+    unused_members_ += entry_capacity_[entry];
+    entry_offset_[entry] = offset;
+    entry_capacity_[entry] = capacity;
+}
+
+void SubscriptionTable::compact_members() {
+    if (unused_members_ < 64 || unused_members_ * 2 < members_.size()) {
+        return;
+    }
+    
+    ArenaVector<std::shared_ptr<Subscription>> members(members_.get_allocator());
+    members.reserve(members_.size() - unused_members_);
+    for (size_t slot = 0; slot < slot_hash_.size(); ++slot) {
+        if (slot_hash_[slot] == 0) {
+            continue;
+        }
+        uint32_t entry = slot_entry_[slot];
+        auto begin = members_.begin() + entry_offset_[entry];
+        entry_offset_[entry] = static_cast<uint32_t>(members.size());
+        members.insert(members.end(), std::make_move_iterator(begin),
+                       std::make_move_iterator(begin + entry_capacity_[entry]));
+    }
+    members_ = std::move(members);
+    unused_members_ = 0;
+}
+
+} // namespace pubsub
@@ -1,6 +1,7 @@
 #include "pubsub/topic.hpp"
 #include "pubsub/message.hpp"
 #include "pubsub/subscription.hpp"
+#include "pubsub/topic_automaton.hpp"
 #include <algorithm>
 #include <regex>
 #include <mutex>
@@ -17,14 +18,59 @@ bool ExactTopicFilter::matches(std::string_view topic) const {
     return topic_ == topic;
 }
 
+std::string_view ExactTopicFilter::pattern() const {
+    return topic_;
+}
+
 // WildcardTopicFilter implementation
 WildcardTopicFilter::WildcardTopicFilter(std::string pattern)
     : pattern_(std::move(pattern))
-    , regex_(wildcardToRegex(pattern_)) {
+    , regex_(wildcardToRegex(pattern_))
+    , level_pattern_(TopicAutomaton::is_level_pattern(pattern_)) {
 }
 
 bool WildcardTopicFilter::matches(std::string_view topic) const {
-    return std::regex_match(std::string(topic), regex_);
+    // MQTT-style patterns never need the regex; it stays for the rest
+    if (level_pattern_) {
+        return matchLevels(pattern_, topic);
+    }
+    return std::regex_match(topic.begin(), topic.end(), regex_);
+}
+
+std::string_view WildcardTopicFilter::pattern() const {
+    return pattern_;
+}
+
+bool WildcardTopicFilter::matchLevels(std::string_view pattern, std::string_view topic) {
+    size_t pattern_pos = 0;
+    size_t topic_pos = 0;
+    bool topic_more = true;
+    
+    for (;;) {
+        size_t pattern_end = pattern.find('/', pattern_pos);
+        std::string_view level = pattern.substr(pattern_pos, pattern_end - pattern_pos);
+        
+        // "#" matches whatever follows, including nothing after a trailing "/"
+        if (level == "#") {
+            return topic_more;
+        }
+        if (!topic_more) {
+            return false;
+        }
+        
+        size_t topic_end = topic.find('/', topic_pos);
+        std::string_view topic_level = topic.substr(topic_pos, topic_end - topic_pos);
+        topic_more = topic_end != std::string_view::npos;
+        topic_pos = topic_end + 1;
+        
+        if (level == "+" ? topic_level.empty() : level != topic_level) {
+            return false;
+        }
+        if (pattern_end == std::string_view::npos) {
+            return !topic_more;
+        }
+        pattern_pos = pattern_end + 1;
+    }
 }
 
 std::string WildcardTopicFilter::wildcardToRegex(const std::string& pattern) {
@@ -53,7 +99,8 @@ std::string WildcardTopicFilter::wildcardToRegex(const std::string& pattern) {
 
 // Topic implementation
 Topic::Topic(std::string name)
-    : name_(std::move(name)) {
+    : name_(std::move(name))
+    , last_activity_(std::chrono::steady_clock::now().time_since_epoch().count()) {
 }
 
 const std::string& Topic::name() const {
@@ -85,13 +132,198 @@ size_t Topic::subscription_count() const {
     return subscriptions_.size();
 }
 
+std::optional<int64_t> Topic::retain(std::shared_ptr<Message> message, size_t max_messages, size_t bytes) {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    
+    if (retired_) {
+        return std::nullopt;
+    }
+    
+    touch();
+    
+    int64_t delta = static_cast<int64_t>(bytes);
+    retained_.push_back(RetainedMessage{std::move(message), bytes});
+    retained_bytes_ += bytes;
+    
+    if (max_messages > 0) {
+        while (retained_.size() > max_messages) {
+            delta -= static_cast<int64_t>(retained_.front().bytes);
+            retained_bytes_ -= retained_.front().bytes;
+            retained_.pop_front();
+        }
+    }
+    
+    return delta;
+}
+
+size_t Topic::evict_retained(size_t bytes) {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    
+    size_t freed = 0;
+    while (freed < bytes && !retained_.empty()) {
+        freed += retained_.front().bytes;
+        retained_.pop_front();
+    }
+    retained_bytes_ -= freed;
+    
+    return freed;
+}
+
+std::vector<std::shared_ptr<Message>> Topic::retained_messages() const {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    
+    std::vector<std::shared_ptr<Message>> result;
+    result.reserve(retained_.size());
+    for (const auto& entry : retained_) {
+        result.push_back(entry.message);
+    }
+    return result;
+}
+
+size_t Topic::retained_count() const {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    return retained_.size();
+}
+
+size_t Topic::retained_bytes() const {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    return retained_bytes_;
+}
+
+size_t Topic::clear_retained_messages() {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    
+    size_t freed = retained_bytes_;
+    retained_.clear();
+    retained_bytes_ = 0;
+    
+    return freed;
+}
+
+void Topic::touch() {
+    last_activity_.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                         std::memory_order_relaxed);
+}
+
+bool Topic::retire_if_idle(std::chrono::steady_clock::time_point now, std::chrono::milliseconds idle_timeout,
+                           const std::function<bool()>& subscribed) {
+    std::lock_guard<std::mutex> lock(retained_mutex_);
+    
+    if (retired_) {
+        return true;
+    }
+    
+    if (!retained_.empty() || partition_count_ > 0 || !subscriptions_.empty()) {
+        return false;
+    }
+    
+    auto last = std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(last_activity_.load(std::memory_order_relaxed)));
+    if (now - last < idle_timeout) {
+        return false;
+    }
+    
+    if (subscribed && subscribed()) {
+        return false;
+    }
+    
+    retired_ = true;
+    return true;
+}
+
+void Topic::set_partition_count(size_t count) {
+    partition_count_ = count;
+    partitions_ = count > 0 ? std::make_unique<PartitionCounters[]>(count) : nullptr;
+}
+
+size_t Topic::partition_count() const {
+    return partition_count_;
+}
+
+size_t Topic::select_partition(const Message& message, const std::string& key_header) {
+    auto it = message.headers().find(key_header);
+    if (it != message.headers().end()) {
+        return std::hash<std::string>{}(it->second) % partition_count_;
+    }
+    return next_partition_.fetch_add(1, std::memory_order_relaxed) % partition_count_;
+}
+
+void Topic::record_published(size_t partition) {
+    partitions_[partition].published.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Topic::record_processed(size_t partition, size_t delivered) {
+    partitions_[partition].delivered.fetch_add(delivered, std::memory_order_relaxed);
+    partitions_[partition].processed.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<PartitionStats> Topic::partition_stats() const {
+    std::vector<PartitionStats> result(partition_count_);
+    
+    for (size_t i = 0; i < partition_count_; ++i) {
+        const auto& counters = partitions_[i];
+        size_t processed = counters.processed.load(std::memory_order_relaxed);
+        size_t published = counters.published.load(std::memory_order_relaxed);
+        
+        result[i].partition = i;
+        result[i].published_messages = published;
+        result[i].delivered_messages = counters.delivered.load(std::memory_order_relaxed);
+        result[i].queued_messages = published > processed ? published - processed : 0;
+    }
+    
+    return result;
+}
+
 // TopicFilterFactory implementation
+namespace {
+
+// Live filters by pattern; entries of released filters are swept as the table grows
+struct FilterRegistry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::weak_ptr<TopicFilter>> filters;
+    size_t sweep_at = 64;
+};
+
+FilterRegistry& filter_registry() {
+    // Never destroyed: filters may be released during static destruction
+    static FilterRegistry* registry = new FilterRegistry();
+    return *registry;
+}
+
+} // namespace
+
 std::shared_ptr<TopicFilter> TopicFilterFactory::create(std::string pattern) {
+    FilterRegistry& registry = filter_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    
+    auto it = registry.filters.find(pattern);
+    if (it != registry.filters.end()) {
+        if (auto filter = it->second.lock()) {
+            return filter;
+        }
+    }
+    
+    std::shared_ptr<TopicFilter> filter;
     if (has_wildcards(pattern)) {
-        return std::make_shared<WildcardTopicFilter>(std::move(pattern));
+        filter = std::make_shared<WildcardTopicFilter>(pattern);
     } else {
-        return std::make_shared<ExactTopicFilter>(std::move(pattern));
+        filter = std::make_shared<ExactTopicFilter>(pattern);
     }
+    
+    if (it != registry.filters.end()) {
+        it->second = filter;
+        return filter;
+    }
+    
+    if (registry.filters.size() >= registry.sweep_at) {
+        for (auto entry = registry.filters.begin(); entry != registry.filters.end();) {
+            entry = entry->second.expired() ? registry.filters.erase(entry) : std::next(entry);
+        }
+        registry.sweep_at = std::max<size_t>(64, registry.filters.size() * 2);
+    }
+    registry.filters.emplace(std::move(pattern), filter);
+    
+    return filter;
 }
 
 bool TopicFilterFactory::has_wildcards(std::string_view pattern) {
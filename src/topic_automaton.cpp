@@ -0,0 +1,402 @@
+#include "pubsub/topic_automaton.hpp"
+#include "pubsub/subscription.hpp"
+#include "pubsub/topic.hpp"
+
+#include <algorithm>
+
+namespace pubsub {
+
+namespace {
+
+/**
+ * @brief Splits a topic or pattern into its "/"-separated levels
+ */
+class LevelReader {
+public:
+    explicit LevelReader(std::string_view text)
+        : text_(text) {
+    }
+    
+    /**
+     * @brief Read the next level
+     * @param level Receives the level
+     * @return false once every level has been read
+     */
+    bool next(std::string_view& level) {
+        if (done_) {
+            return false;
+        }
+        
+        size_t end = text_.find('/', position_);
+        if (end == std::string_view::npos) {
+            level = text_.substr(position_);
+            done_ = true;
+        } else {
+            level = text_.substr(position_, end - position_);
+            position_ = end + 1;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Check if another level follows
+     * @return true unless the last level has been read
+     */
+    bool more() const {
+        return !done_;
+    }
+    
+private:
+    std::string_view text_;
+    size_t position_ = 0;
+    bool done_ = false;
+};
+
+// Characters the regex of WildcardTopicFilter leaves unescaped
+bool has_regex_operators(std::string_view level) {
+    return level.find_first_of("?{}|") != std::string_view::npos;
+}
+
+// Whether the trie gives the same result as the subscription's own filter
+bool fits_trie(const Subscription& subscription) {
+    const TopicFilter* filter = subscription.filter().get();
+    if (dynamic_cast<const ExactTopicFilter*>(filter)) {
+        return true;
+    }
+    return dynamic_cast<const WildcardTopicFilter*>(filter) &&
+           TopicAutomaton::is_level_pattern(filter->pattern());
+}
+
+} // namespace
+
+TopicAutomaton::TopicAutomaton(size_t max_states, std::pmr::memory_resource* resource)
+    : max_states_(std::max<size_t>(max_states, 1))
+    , resource_(ArenaAllocator<char>(resource).resource())
+    , nodes_(resource_)
+    , free_nodes_(resource_)
+    , label_text_(resource_)
+    , label_refs_(resource_)
+    , free_labels_(resource_)
+    , label_ids_(resource_)
+    , states_(resource_)
+    , state_ids_(resource_)
+    , scratch_(resource_)
+    , individual_(resource_) {
+    nodes_.emplace_back(resource_);
+}
+
+size_t TopicAutomaton::NodeSetHash::operator()(const ArenaVector<uint32_t>& nodes) const {
+    size_t hash = nodes.size();
+    for (uint32_t node : nodes) {
+        hash ^= node + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+bool TopicAutomaton::is_level_pattern(std::string_view pattern) {
+    LevelReader reader(pattern);
+    std::string_view level;
+    while (reader.next(level)) {
+        if (level == "#") {
+            if (reader.more()) {
+                return false;
+            }
+        } else if (level != "+" &&
+                   (level.find_first_of("+#") != std::string_view::npos || has_regex_operators(level))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TopicAutomaton::add(const std::shared_ptr<Subscription>& subscription) {
+    size_++;
+    
+    if (!fits_trie(*subscription)) {
+        individual_.push_back(subscription);
+        return;
+    }
+    
+    uint32_t node = 0;
+    LevelReader reader(subscription->filter()->pattern());
+    std::string_view level;
+    while (reader.next(level)) {
+        if (level == "#") {
+            nodes_[node].hash.push_back(subscription);
+            reset_states();
+            return;
+        }
+        
+        if (level == "+") {
+            if (nodes_[node].plus == kNone) {
+                uint32_t child = allocate_node(node, kNone);
+                nodes_[node].plus = child;
+            }
+            node = nodes_[node].plus;
+            continue;
+        }
+        
+        uint32_t label = intern(level);
+        auto it = nodes_[node].children.find(label);
+        if (it != nodes_[node].children.end()) {
+            release(label);
+            node = it->second;
+        } else {
+            uint32_t child = allocate_node(node, label);
+            nodes_[node].children.emplace(label, child);
+            node = child;
+        }
+    }
+    
+    nodes_[node].terminal.push_back(subscription);
+    reset_states();
+}
+
+bool TopicAutomaton::remove(const std::shared_ptr<Subscription>& subscription) {
+    auto erase_from = [&subscription](SubscriptionList& list) {
+        auto it = std::find(list.begin(), list.end(), subscription);
+        if (it == list.end()) {
+            return false;
+        }
+        list.erase(it);
+        return true;
+    };
+    
+    if (!fits_trie(*subscription)) {
+        if (!erase_from(individual_)) {
+            return false;
+        }
+        size_--;
+        return true;
+    }
+    
+    uint32_t node = 0;
+    bool hash = false;
+    LevelReader reader(subscription->filter()->pattern());
+    std::string_view level;
+    while (reader.next(level)) {
+        if (level == "#") {
+            hash = true;
+            break;
+        }
+        
+        if (level == "+") {
+            node = nodes_[node].plus;
+        } else {
+            uint32_t label = find_label(level);
+            auto it = label == kNone ? nodes_[node].children.end() : nodes_[node].children.find(label);
+            node = it == nodes_[node].children.end() ? kNone : it->second;
+        }
+        if (node == kNone) {
+            return false;
+        }
+    }
+    
+    if (!erase_from(hash ? nodes_[node].hash : nodes_[node].terminal)) {
+        return false;
+    }
+    
+    size_--;
+    prune(node);
+    reset_states();
+    return true;
+}
+
+void TopicAutomaton::clear() {
+    nodes_.clear();
+    nodes_.emplace_back(resource_);
+    free_nodes_.clear();
+    label_text_.clear();
+    label_refs_.clear();
+    free_labels_.clear();
+    label_ids_.clear();
+    individual_.clear();
+    size_ = 0;
+    reset_states();
+}
+
+void TopicAutomaton::match(std::string_view topic, std::vector<std::shared_ptr<Subscription>>& matching) {
+    for (const auto& subscription : individual_) {
+        if (subscription->matches(topic)) {
+            matching.push_back(subscription);
+        }
+    }
+    
+    // Restart an overgrown cache between matches, never during one; a
+    // literal-only trie needs about one state per node, so that is allowed on top
+    if (states_.size() > max_states_ + nodes_.size()) {
+        reset_states();
+    }
+    if (states_.empty()) {
+        scratch_.assign(1, 0);
+        state_for(scratch_);
+    }
+    
+    uint32_t state = 0;
+    LevelReader reader(topic);
+    std::string_view level;
+    while (reader.next(level)) {
+        // A trailing "#" matches whatever follows its "/", including nothing
+        for (uint32_t node : states_[state].nodes) {
+            const auto& hash = nodes_[node].hash;
+            matching.insert(matching.end(), hash.begin(), hash.end());
+        }
+        
+        state = step(state, level);
+        if (state == kNone) {
+            return;
+        }
+    }
+    
+    for (uint32_t node : states_[state].nodes) {
+        const auto& terminal = nodes_[node].terminal;
+        matching.insert(matching.end(), terminal.begin(), terminal.end());
+    }
+}
+
+size_t TopicAutomaton::size() const {
+    return size_;
+}
+
+size_t TopicAutomaton::state_count() const {
+    return states_.size();
+}
+
+uint32_t TopicAutomaton::intern(std::string_view label) {
+    auto it = label_ids_.find(label);
+    if (it != label_ids_.end()) {
+        label_refs_[it->second]++;
+        return it->second;
+    }
+    
+    uint32_t id;
+    if (!free_labels_.empty()) {
+        id = free_labels_.back();
+        free_labels_.pop_back();
+        label_text_[id].assign(label.data(), label.size());
+        label_refs_[id] = 1;
+    } else {
+        id = static_cast<uint32_t>(label_text_.size());
+        label_text_.emplace_back(label, label_text_.get_allocator());
+        label_refs_.push_back(1);
+    }
+    label_ids_.emplace(label_text_[id], id);
+    return id;
+}
+
+void TopicAutomaton::release(uint32_t label) {
+    if (--label_refs_[label] == 0) {
+        label_ids_.erase(label_text_[label]);
+        label_text_[label].clear();
+        free_labels_.push_back(label);
+    }
+}
+
+uint32_t TopicAutomaton::find_label(std::string_view label) const {
+    auto it = label_ids_.find(label);
+    return it == label_ids_.end() ? kNone : it->second;
+}
+
+uint32_t TopicAutomaton::allocate_node(uint32_t parent, uint32_t label) {
+    uint32_t id;
+    if (!free_nodes_.empty()) {
+        id = free_nodes_.back();
+        free_nodes_.pop_back();
+    } else {
+        id = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back(resource_);
+    }
+    nodes_[id].parent = parent;
+    nodes_[id].label = label;
+    return id;
+}
+
+void TopicAutomaton::prune(uint32_t node) {
+    // Unlink nodes that no longer lead to any pattern, bottom up
+    while (node != 0) {
+        Node& current = nodes_[node];
+        if (!current.children.empty() || current.plus != kNone ||
+            !current.terminal.empty() || !current.hash.empty()) {
+            return;
+        }
+        
+        uint32_t parent = current.parent;
+        if (current.label == kNone) {
+            nodes_[parent].plus = kNone;
+        } else {
+            nodes_[parent].children.erase(current.label);
+            release(current.label);
+        }
+        
+        nodes_[node] = Node(resource_);
+        free_nodes_.push_back(node);
+        node = parent;
+    }
+}
+
+void TopicAutomaton::reset_states() {
+    states_.clear();
+    state_ids_.clear();
+}
+
+uint32_t TopicAutomaton::state_for(ArenaVector<uint32_t>& nodes) {
+    if (nodes.empty()) {
+        return kNone;
+    }
+    
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    
+    auto it = state_ids_.find(nodes);
+    if (it != state_ids_.end()) {
+        return it->second;
+    }
+    
+    auto id = static_cast<uint32_t>(states_.size());
+    states_.emplace_back(resource_);
+    states_.back().nodes.assign(nodes.begin(), nodes.end());
+    state_ids_.emplace(nodes, id);
+    return id;
+}
+
+uint32_t TopicAutomaton::step(uint32_t state, std::string_view level) {
+    // Levels that are no pattern's literal can only be taken by "+"
+    uint32_t label = find_label(level);
+    
+    if (label != kNone) {
+        auto it = states_[state].transitions.find(label);
+        if (it != states_[state].transitions.end()) {
+            return it->second;
+        }
+    } else if (level.empty()) {
+        return kNone;
+    } else if (states_[state].other_known) {
+        return states_[state].other;
+    }
+    
+    scratch_.clear();
+    for (uint32_t node : states_[state].nodes) {
+        const Node& current = nodes_[node];
+        if (label != kNone) {
+            auto child = current.children.find(label);
+            if (child != current.children.end()) {
+                scratch_.push_back(child->second);
+            }
+        }
+        if (current.plus != kNone && !level.empty()) {
+            scratch_.push_back(current.plus);
+        }
+    }
+    
+    // states_ may grow here, so the state is looked up again afterwards
+    uint32_t next = state_for(scratch_);
+    if (label != kNone) {
+        states_[state].transitions.emplace(label, next);
+    } else {
+        states_[state].other = next;
+        states_[state].other_known = true;
+    }
+    return next;
+}
+
+} // namespace pubsub
@@ -0,0 +1,75 @@
+// DuplicateFilter window: recent keys are caught, keys far outside the
+// window are forgotten once their generation is reused, and erase(), scopes
+// and the time bound behave as documented.
+
+#include "pubsub/dedup.hpp"
+
+#include "test_support.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+using pubsub::DuplicateFilter;
+
+std::string key(int i) {
+    return "key-" + std::to_string(i);
+}
+
+void test_count_window() {
+    constexpr int kWindow = 100;
+    constexpr int kKeys = 1000;
+
+    DuplicateFilter filter(kWindow);
+    for (int i = 0; i < kKeys; ++i) {
+        PUBSUB_CHECK(!filter.check_and_insert(key(i)));
+    }
+
+    // The most recent window is remembered
+    for (int i = kKeys - kWindow; i < kKeys; ++i) {
+        PUBSUB_CHECK(filter.check_and_insert(key(i)));
+    }
+
+    // Keys from generations reused several times over are gone
+    for (int i = 0; i < kWindow; ++i) {
+        PUBSUB_CHECK(!filter.check_and_insert(key(i)));
+    }
+    PUBSUB_CHECK(filter.size() <= 2 * kWindow);
+}
+
+void test_erase_and_scope() {
+    DuplicateFilter filter(16);
+    PUBSUB_CHECK(!filter.check_and_insert("order", "topic/a"));
+    PUBSUB_CHECK(!filter.check_and_insert("order", "topic/b"));
+    PUBSUB_CHECK(filter.check_and_insert("order", "topic/a"));
+
+    PUBSUB_CHECK(filter.erase("order", "topic/a"));
+    PUBSUB_CHECK(!filter.erase("order", "topic/a"));
+    PUBSUB_CHECK(!filter.check_and_insert("order", "topic/a"));
+    PUBSUB_CHECK(filter.check_and_insert("order", "topic/b"));
+
+    filter.clear();
+    PUBSUB_CHECK(filter.size() == 0);
+    PUBSUB_CHECK(!filter.check_and_insert("order", "topic/b"));
+}
+
+void test_time_window() {
+    DuplicateFilter filter(1000, 30);
+    PUBSUB_CHECK(!filter.check_and_insert("tick"));
+    PUBSUB_CHECK(filter.check_and_insert("tick"));
+
+    // An idle period longer than the window expires every key
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    PUBSUB_CHECK(!filter.check_and_insert("tick"));
+}
+
+} // namespace
+
+int main() {
+    test_count_window();
+    test_erase_and_scope();
+    test_time_window();
+    return pubsub::test::result();
+}
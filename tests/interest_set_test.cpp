@@ -0,0 +1,181 @@
+// Randomized add/remove on InterestSet: the changes it reports add up to the
+// advertised cover, the cover stays minimal and complete for the live
+// patterns, and covers() agrees with WildcardTopicFilter on sample topics.
+
+#include "pubsub/federation.hpp"
+#include "pubsub/topic.hpp"
+
+#include "test_support.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pubsub::InterestChange;
+using pubsub::InterestSet;
+using pubsub::WildcardTopicFilter;
+
+std::vector<std::string> all_patterns() {
+    // Up to three levels of "a", "b", "+" and a trailing "#"
+    const std::vector<std::string> levels = {"a", "b", "+"};
+    std::vector<std::string> patterns = {"#"};
+    std::vector<std::string> prefixes = {""};
+    for (int depth = 0; depth < 3; ++depth) {
+        std::vector<std::string> next;
+        for (const auto& prefix : prefixes) {
+            for (const auto& level : levels) {
+                std::string pattern = prefix.empty() ? level : prefix + "/" + level;
+                patterns.push_back(pattern);
+                patterns.push_back(pattern + "/#");
+                next.push_back(pattern);
+            }
+        }
+        prefixes = next;
+    }
+    return patterns;
+}
+
+std::vector<std::string> sample_topics() {
+    std::vector<std::string> topics;
+    std::vector<std::string> prefixes = {""};
+    for (int depth = 0; depth < 4; ++depth) {
+        std::vector<std::string> next;
+        for (const auto& prefix : prefixes) {
+            for (const char* level : {"a", "b", "c"}) {
+                std::string topic = prefix.empty() ? level : prefix + "/" + level;
+                topics.push_back(topic);
+                next.push_back(topic);
+            }
+        }
+        prefixes = next;
+    }
+    return topics;
+}
+
+void apply_change(const InterestChange& change, std::set<std::string>& advertised) {
+    for (const auto& pattern : change.removed) {
+        PUBSUB_CHECK(advertised.erase(pattern) == 1);
+    }
+    for (const auto& pattern : change.added) {
+        PUBSUB_CHECK(advertised.insert(pattern).second);
+    }
+}
+
+bool check_cover(const InterestSet& interest, const std::map<std::string, int>& live,
+                 const std::set<std::string>& advertised) {
+    std::vector<std::string> cover = interest.patterns();
+    if (!std::equal(cover.begin(), cover.end(), advertised.begin(), advertised.end())) {
+        return false;
+    }
+
+    for (const auto& pattern : cover) {
+        // Advertised patterns are live and do not cover one another
+        if (live.count(pattern) == 0) {
+            return false;
+        }
+        for (const auto& other : cover) {
+            if (other != pattern && InterestSet::covers(other, pattern)) {
+                return false;
+            }
+        }
+    }
+
+    // Every live pattern is reached through the cover
+    for (const auto& [pattern, count] : live) {
+        bool covered = std::any_of(cover.begin(), cover.end(), [&pattern](const std::string& general) {
+            return InterestSet::covers(general, pattern);
+        });
+        if (!covered) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_covers_is_sound() {
+    std::vector<std::string> patterns = all_patterns();
+    std::vector<std::string> topics = sample_topics();
+
+    std::vector<WildcardTopicFilter> filters;
+    for (const auto& pattern : patterns) {
+        filters.emplace_back(pattern);
+    }
+
+    for (size_t g = 0; g < patterns.size(); ++g) {
+        for (size_t s = 0; s < patterns.size(); ++s) {
+            if (!InterestSet::covers(patterns[g], patterns[s])) {
+                continue;
+            }
+            for (const auto& topic : topics) {
+                if (filters[s].matches(topic) && !filters[g].matches(topic)) {
+                    std::fprintf(stderr, "%s covers %s but misses %s\n",
+                                 patterns[g].c_str(), patterns[s].c_str(), topic.c_str());
+                    PUBSUB_CHECK(false);
+                }
+            }
+        }
+    }
+
+    PUBSUB_CHECK(InterestSet::covers("a/#", "a/+/b"));
+    PUBSUB_CHECK(!InterestSet::covers("a/#", "a"));
+    PUBSUB_CHECK(!InterestSet::covers("a/+", "a/#"));
+}
+
+void test_random_add_remove() {
+    std::vector<std::string> patterns = all_patterns();
+    std::mt19937 rng(20240607);
+    std::uniform_int_distribution<size_t> pick(0, patterns.size() - 1);
+
+    size_t violations = 0;
+    for (int round = 0; round < 20; ++round) {
+        InterestSet interest;
+        std::map<std::string, int> live;
+        std::set<std::string> advertised;
+
+        for (int step = 0; step < 300; ++step) {
+            const std::string& pattern = patterns[pick(rng)];
+            // Lean towards adding early on and towards removing later
+            bool add = live.count(pattern) == 0 || rng() % 300 > static_cast<unsigned>(step);
+            if (add) {
+                apply_change(interest.add(pattern), advertised);
+                live[pattern]++;
+            } else {
+                apply_change(interest.remove(pattern), advertised);
+                if (--live[pattern] == 0) {
+                    live.erase(pattern);
+                }
+            }
+            if (!check_cover(interest, live, advertised)) {
+                ++violations;
+            }
+        }
+
+        // Removing everything leaves nothing advertised
+        while (!live.empty()) {
+            auto it = live.begin();
+            apply_change(interest.remove(it->first), advertised);
+            if (--it->second == 0) {
+                live.erase(it);
+            }
+        }
+        PUBSUB_CHECK(advertised.empty());
+        PUBSUB_CHECK(interest.patterns().empty());
+    }
+
+    std::printf("%zu cover violations\n", violations);
+    PUBSUB_CHECK(violations == 0);
+}
+
+} // namespace
+
+int main() {
+    test_covers_is_sound();
+    test_random_add_remove();
+    return pubsub::test::result();
+}
@@ -0,0 +1,77 @@
+// Partitioned topics: messages sharing a partition key are delivered in
+// publish order even though several lanes run at once, and every message
+// lands in exactly one partition.
+
+#include "pubsub/broker.hpp"
+#include "pubsub/message.hpp"
+
+#include "test_support.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace pubsub;
+
+void test_per_key_order() {
+    constexpr int kPublishers = 4;
+    constexpr int kKeysPerPublisher = 4;
+    constexpr int kPerKey = 500;
+    constexpr size_t kPartitions = 8;
+
+    BrokerConfig config;
+    config.thread_count = 2;
+    config.partition_lanes = 4;
+    auto& broker = Broker::instance();
+    broker.initialize(config);
+    PUBSUB_CHECK(broker.create_partitioned_topic("orders", kPartitions));
+
+    std::mutex mutex;
+    std::map<std::string, int> last;
+    int out_of_order = 0;
+    int received = 0;
+    broker.subscribe("orders", [&](const Message& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [it, inserted] = last.emplace(message.get_header("partition-key"), -1);
+        int sequence = message.payload<int>();
+        out_of_order += sequence == it->second + 1 ? 0 : 1;
+        it->second = sequence;
+        received++;
+    });
+
+    // Each key has a single publisher, so its publish order is well defined
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < kPublishers; ++p) {
+        publishers.emplace_back([&broker, p]() {
+            for (int i = 0; i < kPerKey; ++i) {
+                for (int k = 0; k < kKeysPerPublisher; ++k) {
+                    auto message = Message::create("orders", i);
+                    message->set_header("partition-key", "key-" + std::to_string(p * kKeysPerPublisher + k));
+                    broker.publish("orders", message);
+                }
+            }
+        });
+    }
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+
+    auto partitions = broker.get_partition_stats("orders");
+    broker.shutdown();
+
+    PUBSUB_CHECK(partitions.size() == kPartitions);
+    PUBSUB_CHECK(received == kPublishers * kKeysPerPublisher * kPerKey);
+    PUBSUB_CHECK(last.size() == static_cast<size_t>(kPublishers * kKeysPerPublisher));
+    PUBSUB_CHECK(out_of_order == 0);
+}
+
+} // namespace
+
+int main() {
+    test_per_key_order();
+    return pubsub::test::result();
+}
@@ -0,0 +1,165 @@
+// Ring buffer claim, gating and wrap-around, on the RingBuffer itself and
+// through the broker's ring engine, including a shutdown that cuts
+// waiting publishers short.
+
+#include "pubsub/broker.hpp"
+#include "pubsub/message.hpp"
+#include "pubsub/ring_buffer.hpp"
+
+#include "test_support.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using pubsub::RingBuffer;
+using pubsub::Sequence;
+
+void test_claim_and_gating() {
+    RingBuffer<int> ring(3);
+    PUBSUB_CHECK(ring.capacity() == 4);
+
+    Sequence consumer;
+    ring.set_gating({&consumer});
+
+    // A full ring rejects until the consumer moves past the oldest slot
+    int64_t sequence = -1;
+    for (int64_t expected = 0; expected < 4; ++expected) {
+        PUBSUB_CHECK(ring.try_claim(sequence) && sequence == expected);
+        ring[sequence] = static_cast<int>(sequence);
+    }
+    PUBSUB_CHECK(!ring.try_claim(sequence));
+
+    consumer.set(0);
+    PUBSUB_CHECK(ring.try_claim(sequence) && sequence == 4);
+    PUBSUB_CHECK(&ring[4] == &ring[0]);
+
+    // An abandoned wait keeps the sequence claimed
+    PUBSUB_CHECK(!ring.claim([]() { return false; }, sequence) && sequence == 5);
+    PUBSUB_CHECK(ring.claimed() == 5);
+}
+
+void test_out_of_order_publish() {
+    RingBuffer<int> ring(8);
+    int64_t sequence = -1;
+    for (int i = 0; i < 4; ++i) {
+        ring.try_claim(sequence);
+    }
+
+    // Consumers only see the contiguous run of published sequences
+    ring.publish(0);
+    ring.publish(2);
+    ring.publish(3);
+    PUBSUB_CHECK(ring.highest_available(0) == 0);
+    PUBSUB_CHECK(!ring.is_available(1));
+    ring.publish(1);
+    PUBSUB_CHECK(ring.highest_available(0) == 3);
+}
+
+void test_concurrent_producers() {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 20000;
+
+    RingBuffer<int> ring(64);
+    Sequence consumer;
+    ring.set_gating({&consumer});
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ring, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                int64_t sequence = 0;
+                ring.claim([]() { return true; }, sequence);
+                ring[sequence] = p * kPerProducer + i;
+                ring.publish(sequence);
+            }
+        });
+    }
+
+    // Each value arrives once, and each producer's values arrive in order
+    std::vector<int> last(kProducers, -1);
+    std::vector<bool> seen(kProducers * kPerProducer, false);
+    bool ordered = true;
+    bool unique = true;
+    int64_t next = 0;
+    while (next < kProducers * kPerProducer) {
+        int64_t available = ring.highest_available(next);
+        for (; next <= available; ++next) {
+            int value = ring[next];
+            unique = unique && !seen[value];
+            seen[value] = true;
+            ordered = ordered && value % kPerProducer > last[value / kPerProducer];
+            last[value / kPerProducer] = value % kPerProducer;
+        }
+        consumer.set(next - 1);
+        std::this_thread::yield();
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    PUBSUB_CHECK(unique);
+    PUBSUB_CHECK(ordered);
+}
+
+void test_engine_shutdown_reports_every_publish() {
+    using namespace pubsub;
+
+    auto& broker = Broker::instance();
+    for (int run = 0; run < 5; ++run) {
+        BrokerConfig config;
+        config.thread_count = 2;
+        config.dispatch_engine = DispatchEngine::Ring;
+        config.ring_capacity = 8;
+        config.overflow_policy = OverflowPolicy::DropOldest;
+        broker.initialize(config);
+
+        std::atomic<int> received{0};
+        broker.subscribe("ring/#", [&received](const Message&) {
+            received++;
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        });
+
+        // Publishers wait for slots on the small ring while shutdown cuts them short
+        constexpr int kPublishers = 4;
+        constexpr int kPerPublisher = 200;
+        std::atomic<int> completed{0};
+        std::atomic<int> delivered{0};
+        std::atomic<int> evicted{0};
+        std::vector<std::thread> publishers;
+        for (int p = 0; p < kPublishers; ++p) {
+            publishers.emplace_back([&]() {
+                for (int i = 0; i < kPerPublisher; ++i) {
+                    broker.publish_async("ring/a", Message::create("ring/a", i), [&](const DeliveryReport& report) {
+                        completed++;
+                        delivered += static_cast<int>(report.delivered);
+                        evicted += report.evicted ? 1 : 0;
+                    });
+                }
+            });
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        broker.shutdown();
+        for (auto& publisher : publishers) {
+            publisher.join();
+        }
+
+        PUBSUB_CHECK(completed == kPublishers * kPerPublisher);
+        PUBSUB_CHECK(delivered == received);
+    }
+}
+
+} // namespace
+
+int main() {
+    test_claim_and_gating();
+    test_out_of_order_publish();
+    test_concurrent_producers();
+    test_engine_shutdown_reports_every_publish();
+    return pubsub::test::result();
+}
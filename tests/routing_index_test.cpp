@@ -0,0 +1,138 @@
+// Randomized equivalence test of the routing indexes: subscriptions are
+// added and removed at random, and for every probe topic the automaton and
+// the table must return exactly the subscriptions a reference regex accepts.
+
+#include "pubsub/subscription.hpp"
+#include "pubsub/subscription_table.hpp"
+#include "pubsub/topic_automaton.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using pubsub::Subscription;
+using Subscriptions = std::vector<std::shared_ptr<Subscription>>;
+
+/**
+ * @brief Reference translation of an MQTT-style pattern to a regex
+ */
+std::regex reference_regex(const std::string& pattern) {
+    std::string result;
+    for (char c : pattern) {
+        if (c == '+') {
+            result += "[^/]+";
+        } else if (c == '#') {
+            result += ".*";
+        } else if (std::string_view(".*[]()\\^$").find(c) != std::string_view::npos) {
+            result += '\\';
+            result += c;
+        } else {
+            result += c;
+        }
+    }
+    return std::regex(result);
+}
+
+/**
+ * @brief Random pattern or topic built from a small alphabet of levels
+ */
+std::string random_levels(std::mt19937& rng, const std::vector<std::string>& alphabet, size_t max_levels) {
+    size_t levels = 1 + rng() % max_levels;
+    std::string text;
+    for (size_t i = 0; i < levels; ++i) {
+        if (i > 0) {
+            text += '/';
+        }
+        text += alphabet[rng() % alphabet.size()];
+    }
+    return text;
+}
+
+/**
+ * @brief Subscription with the reference semantics of its pattern
+ *
+ * Patterns without "+" or "#" are exact topics; the rest go through the regex.
+ */
+struct Entry {
+    std::shared_ptr<Subscription> subscription;
+    std::string pattern;
+    bool exact = false;
+    std::regex regex;
+    
+    bool matches(const std::string& topic) const {
+        return exact ? pattern == topic : std::regex_match(topic, regex);
+    }
+};
+
+Subscriptions sorted(Subscriptions subscriptions) {
+    std::sort(subscriptions.begin(), subscriptions.end());
+    return subscriptions;
+}
+
+} // namespace
+
+int main() {
+    // Literal, wildcard and regex-operator levels, so both the trie and the
+    // one-by-one fallback of the automaton are exercised
+    const std::vector<std::string> pattern_levels = {"a", "b", "c", "", "+", "+", "#", "#", "a.b", "a?", "x|y"};
+    const std::vector<std::string> topic_levels = {"a", "b", "c", "", "a.b", "axb", "a?", "x|y", "x", "y"};
+    
+    std::mt19937 rng(20261017);
+    pubsub::TopicAutomaton automaton(64);
+    pubsub::SubscriptionTable table;
+    std::vector<Entry> entries;
+    
+    size_t probes = 0;
+    size_t failures = 0;
+    for (int round = 0; round < 1000 && failures < 10; ++round) {
+        // Churn the subscriptions, with a small state budget to force rebuilds
+        if (entries.size() < 16 || (entries.size() < 128 && rng() % 2 == 0)) {
+            std::string pattern = random_levels(rng, pattern_levels, 4);
+            auto subscription = Subscription::create(pattern, Subscription::MessageRefCallback([](const pubsub::Message&) {}));
+            automaton.add(subscription);
+            table.add(subscription);
+            bool exact = pattern.find_first_of("+#") == std::string::npos;
+            entries.push_back({subscription, pattern, exact, exact ? std::regex() : reference_regex(pattern)});
+        } else {
+            size_t index = rng() % entries.size();
+            automaton.remove(entries[index].subscription);
+            table.remove(entries[index].subscription);
+            entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(index));
+        }
+        
+        for (int probe = 0; probe < 20; ++probe) {
+            std::string topic = random_levels(rng, topic_levels, 5);
+            
+            Subscriptions expected;
+            for (const auto& entry : entries) {
+                if (entry.matches(topic)) {
+                    expected.push_back(entry.subscription);
+                }
+            }
+            expected = sorted(std::move(expected));
+            
+            Subscriptions from_automaton;
+            automaton.match(topic, from_automaton);
+            Subscriptions from_table;
+            table.match(topic, from_table);
+            
+            ++probes;
+            bool automaton_ok = sorted(std::move(from_automaton)) == expected;
+            bool table_ok = sorted(std::move(from_table)) == expected;
+            if (!automaton_ok || !table_ok) {
+                ++failures;
+                std::fprintf(stderr, "mismatch on topic \"%s\" (automaton %s, table %s)\n",
+                             topic.c_str(), automaton_ok ? "ok" : "wrong", table_ok ? "ok" : "wrong");
+            }
+        }
+    }
+    
+    std::printf("%zu probes, %zu mismatches\n", probes, failures);
+    return failures == 0 ? 0 : 1;
+}
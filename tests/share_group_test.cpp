@@ -0,0 +1,108 @@
+// Shared subscription groups: each message reaches exactly one member,
+// round robin spreads messages evenly, key hashing keeps a key on one member
+// and ordinary subscribers on the same topics still see every message.
+
+#include "pubsub/broker.hpp"
+#include "pubsub/message.hpp"
+
+#include "test_support.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace pubsub;
+
+void test_round_robin() {
+    constexpr int kMembers = 3;
+    constexpr int kMessages = 300;
+
+    BrokerConfig config;
+    config.thread_count = 2;
+    auto& broker = Broker::instance();
+    broker.initialize(config);
+
+    std::mutex mutex;
+    std::vector<int> per_member(kMembers, 0);
+    std::vector<int> copies(kMessages, 0);
+    int observed = 0;
+
+    for (int m = 0; m < kMembers; ++m) {
+        broker.subscribe("$share/workers/jobs/#", [&, m](const Message& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            per_member[m]++;
+            copies[message.payload<int>()]++;
+        });
+    }
+    broker.subscribe("jobs/#", [&](const Message&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        observed++;
+    });
+
+    for (int i = 0; i < kMessages; ++i) {
+        broker.publish("jobs/build", Message::create("jobs/build", i));
+    }
+    broker.shutdown();
+
+    for (int count : copies) {
+        PUBSUB_CHECK(count == 1);
+    }
+    for (int count : per_member) {
+        PUBSUB_CHECK(count == kMessages / kMembers);
+    }
+    PUBSUB_CHECK(observed == kMessages);
+}
+
+void test_key_hash() {
+    constexpr int kMembers = 4;
+    constexpr int kKeys = 16;
+    constexpr int kPerKey = 20;
+
+    BrokerConfig config;
+    config.thread_count = 2;
+    auto& broker = Broker::instance();
+    broker.initialize(config);
+
+    SubscriptionOptions options;
+    options.share_strategy = ShareStrategy::KeyHash;
+    options.share_key_header = "customer";
+
+    std::mutex mutex;
+    std::map<std::string, std::vector<int>> members_by_key;
+    std::vector<std::shared_ptr<Subscription>> members;
+    for (int m = 0; m < kMembers; ++m) {
+        members.push_back(broker.subscribe("$share/billing/invoices", [&, m](const Message& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            members_by_key[message.get_header("customer")].push_back(m);
+        }, options));
+    }
+
+    for (int i = 0; i < kPerKey; ++i) {
+        for (int k = 0; k < kKeys; ++k) {
+            auto message = Message::create("invoices", i);
+            message->set_header("customer", "customer-" + std::to_string(k));
+            broker.publish("invoices", message);
+        }
+    }
+    broker.shutdown();
+
+    PUBSUB_CHECK(members_by_key.size() == kKeys);
+    for (const auto& [customer, receivers] : members_by_key) {
+        PUBSUB_CHECK(receivers.size() == kPerKey);
+        for (int member : receivers) {
+            PUBSUB_CHECK(member == receivers.front());
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_round_robin();
+    test_key_hash();
+    return pubsub::test::result();
+}
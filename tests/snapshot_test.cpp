@@ -0,0 +1,134 @@
+// Snapshot save/load round trip: the writer and the mapped reader directly,
+// then retained messages carried across broker restarts, including topics
+// that were never touched between two snapshots.
+
+#include "pubsub/broker.hpp"
+#include "pubsub/codec.hpp"
+#include "pubsub/message.hpp"
+#include "pubsub/snapshot.hpp"
+
+#include "test_support.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace pubsub;
+
+using TestSerializer = TypedSerializer<int32_t, std::string>;
+
+std::string snapshot_file(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+int32_t payload_of(const Message& message) {
+    return message.has_payload_type<int32_t>() ? message.payload<int32_t>() : -1;
+}
+
+void test_writer_and_reader() {
+    std::string path = snapshot_file("pubsub_snapshot_test_direct.snap");
+    auto serializer = std::make_shared<TestSerializer>();
+
+    auto first = Message::create("sensors/a", int32_t{1}, Priority::High);
+    first->set_header("unit", "celsius");
+    auto second = Message::create("sensors/a", std::string("two"));
+
+    {
+        // Topics are added out of order; finish() sorts the index
+        SnapshotWriter writer(path, serializer.get());
+        PUBSUB_CHECK(writer.is_open());
+        writer.add_topic("sensors/b", {});
+        writer.add_topic("sensors/a", {first, second});
+        writer.add_topic("alerts", {Message::create("alerts", int32_t{3})});
+        PUBSUB_CHECK(writer.finish());
+    }
+
+    auto snapshot = Snapshot::open(path);
+    PUBSUB_CHECK(snapshot != nullptr);
+    if (!snapshot) {
+        return;
+    }
+
+    PUBSUB_CHECK(snapshot->topic_count() == 3);
+    PUBSUB_CHECK(snapshot->topic_name(0) == "alerts");
+    PUBSUB_CHECK(snapshot->topic_name(1) == "sensors/a");
+    PUBSUB_CHECK(snapshot->lower_bound("sensors/") == 1);
+    PUBSUB_CHECK(snapshot->lower_bound("zzz") == 3);
+
+    size_t index = 0;
+    PUBSUB_CHECK(!snapshot->find("sensors", index));
+    PUBSUB_CHECK(snapshot->find("sensors/b", index) && snapshot->message_count(index) == 0);
+    PUBSUB_CHECK(snapshot->find("sensors/a", index) && snapshot->message_count(index) == 2);
+
+    auto messages = snapshot->load_messages(index, serializer);
+    PUBSUB_CHECK(messages.size() == 2);
+    if (messages.size() == 2) {
+        PUBSUB_CHECK(messages[0]->id() == first->id());
+        PUBSUB_CHECK(messages[0]->topic() == "sensors/a");
+        PUBSUB_CHECK(messages[0]->timestamp() == first->timestamp());
+        PUBSUB_CHECK(messages[0]->priority() == Priority::High);
+        PUBSUB_CHECK(messages[0]->get_header("unit") == "celsius");
+        PUBSUB_CHECK(payload_of(*messages[0]) == 1);
+        PUBSUB_CHECK(messages[1]->has_payload_type<std::string>() && messages[1]->payload<std::string>() == "two");
+    }
+
+    // The encoded bytes decode without the virtual serializer as well
+    if (!messages.empty() && messages[0]->has_encoded_payload()) {
+        int32_t value = 0;
+        PUBSUB_CHECK(TestSerializer::decode(messages[0]->encoded_payload(), value) && value == 1);
+    }
+
+    snapshot.reset();
+    std::remove(path.c_str());
+}
+
+void test_broker_restart() {
+    std::string path = snapshot_file("pubsub_snapshot_test_broker.snap");
+    std::remove(path.c_str());
+
+    BrokerConfig config;
+    config.snapshot_path = path;
+    config.snapshot_serializer = std::make_shared<TestSerializer>();
+
+    auto& broker = Broker::instance();
+    broker.initialize(config);
+    for (int32_t i = 0; i < 3; ++i) {
+        broker.publish("room/kitchen", Message::create("room/kitchen", i));
+    }
+    broker.publish("room/hall", Message::create("room/hall", int32_t{10}));
+    broker.shutdown();
+
+    // Only the kitchen is touched; the hall must still be copied into the next snapshot
+    broker.initialize(config);
+    auto kitchen = broker.get_retained_messages("room/kitchen");
+    PUBSUB_CHECK(kitchen.size() == 3);
+    for (size_t i = 0; i < kitchen.size(); ++i) {
+        PUBSUB_CHECK(payload_of(*kitchen[i]) == static_cast<int32_t>(i));
+    }
+    broker.publish("room/kitchen", Message::create("room/kitchen", int32_t{3}));
+    broker.shutdown();
+
+    broker.initialize(config);
+    kitchen = broker.get_retained_messages("room/kitchen");
+    PUBSUB_CHECK(kitchen.size() == 4);
+    PUBSUB_CHECK(!kitchen.empty() && payload_of(*kitchen.back()) == 3);
+    auto hall = broker.get_retained_messages("room/hall");
+    PUBSUB_CHECK(hall.size() == 1);
+    PUBSUB_CHECK(!hall.empty() && payload_of(*hall.front()) == 10);
+    broker.shutdown();
+
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    test_writer_and_reader();
+    test_broker_restart();
+    return pubsub::test::result();
+}
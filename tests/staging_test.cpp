@@ -0,0 +1,71 @@
+// Publish staging: messages left in the buffers of several publishing
+// threads, including threads that have already exited, are all delivered
+// once shutdown() flushes them.
+
+#include "pubsub/broker.hpp"
+#include "pubsub/message.hpp"
+
+#include "test_support.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace pubsub;
+
+void test_shutdown_flushes_staged_messages() {
+    constexpr int kPublishers = 4;
+    constexpr int kPerPublisher = 1001;
+
+    BrokerConfig config;
+    config.thread_count = 2;
+    config.publish_staging_size = 32;
+    config.publish_staging_us = 0;
+
+    auto& broker = Broker::instance();
+    broker.initialize(config);
+
+    std::mutex mutex;
+    std::vector<bool> seen(kPublishers * kPerPublisher, false);
+    int duplicates = 0;
+    std::atomic<int> received{0};
+    broker.subscribe("staging/#", [&](const Message& message) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int value = message.payload<int>();
+        duplicates += seen[value] ? 1 : 0;
+        seen[value] = true;
+        received++;
+    });
+
+    std::atomic<int> accepted{0};
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < kPublishers; ++p) {
+        publishers.emplace_back([&broker, &accepted, p]() {
+            for (int i = 0; i < kPerPublisher; ++i) {
+                if (broker.publish("staging/a", Message::create("staging/a", p * kPerPublisher + i))) {
+                    accepted++;
+                }
+            }
+        });
+    }
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+
+    // Every buffer still holds a partial batch; only shutdown() hands it over
+    broker.shutdown();
+
+    PUBSUB_CHECK(accepted == kPublishers * kPerPublisher);
+    PUBSUB_CHECK(received == accepted);
+    PUBSUB_CHECK(duplicates == 0);
+}
+
+} // namespace
+
+int main() {
+    test_shutdown_flushes_staged_messages();
+    return pubsub::test::result();
+}
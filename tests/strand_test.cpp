@@ -0,0 +1,89 @@
+// Strand subscriptions delivered from several threads at once: callbacks
+// never overlap, each producer's messages run in order and none is lost,
+// both inline and on a thread pool where the strand is claimed and released
+// over and over.
+
+#include "pubsub/executor.hpp"
+#include "pubsub/message.hpp"
+#include "pubsub/subscription.hpp"
+
+#include "test_support.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace pubsub;
+
+void run_strand(std::shared_ptr<Executor> executor) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 5000;
+
+    // Touched only from the callback, which the strand serializes
+    std::vector<int> last(kProducers, -1);
+    bool ordered = true;
+    int received = 0;
+
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    std::atomic<int> completed{0};
+
+    SubscriptionOptions options;
+    options.strand = true;
+    options.executor = executor;
+    auto subscription = Subscription::create("strand/#", Subscription::MessageRefCallback([&](const Message& message) {
+        if (running.fetch_add(1) != 0) {
+            overlapped = true;
+        }
+        int value = message.payload<int>();
+        int producer = value / kPerProducer;
+        ordered = ordered && value % kPerProducer == last[producer] + 1;
+        last[producer] = value % kPerProducer;
+        ++received;
+        running.fetch_sub(1);
+        completed.fetch_add(1, std::memory_order_release);
+    }), options);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&subscription, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                subscription->deliver(Message::create("strand/a", p * kPerProducer + i));
+                // Let the strand drain now and then so it is released and re-claimed
+                if (i % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (completed.load(std::memory_order_acquire) < kProducers * kPerProducer &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    PUBSUB_CHECK(completed.load(std::memory_order_acquire) == kProducers * kPerProducer);
+    PUBSUB_CHECK(received == kProducers * kPerProducer);
+    PUBSUB_CHECK(!overlapped);
+    PUBSUB_CHECK(ordered);
+}
+
+} // namespace
+
+int main() {
+    run_strand(nullptr);
+
+    auto pool = std::make_shared<ThreadPoolExecutor>(4);
+    run_strand(pool);
+    pool->shutdown();
+
+    return pubsub::test::result();
+}
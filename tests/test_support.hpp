@@ -0,0 +1,42 @@
+#ifndef CPP_PUBSUB_TEST_SUPPORT_HPP
+#define CPP_PUBSUB_TEST_SUPPORT_HPP
+
+#include <cstdio>
+
+namespace pubsub {
+namespace test {
+
+/**
+ * @brief Number of failed checks in this test program
+ */
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/**
+ * @brief Record a failed check without stopping the test
+ */
+inline void report_failure(const char* expression, const char* file, int line) {
+    ++failures();
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+}
+
+/**
+ * @brief Exit code of the test program
+ */
+inline int result() {
+    if (failures() > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace test
+} // namespace pubsub
+
+#define PUBSUB_CHECK(expression) \
+    ((expression) ? (void)0 : ::pubsub::test::report_failure(#expression, __FILE__, __LINE__))
+
+#endif // CPP_PUBSUB_TEST_SUPPORT_HPP
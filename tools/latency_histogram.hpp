@@ -0,0 +1,101 @@
+#ifndef CPP_PUBSUB_TOOLS_LATENCY_HISTOGRAM_HPP
+#define CPP_PUBSUB_TOOLS_LATENCY_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace pubsub {
+namespace tools {
+
+/**
+ * @brief Lock-free log-linear latency histogram
+ *
+ * Values are bucketed by their power of two and eight linear sub-buckets
+ * within it, giving roughly 12% relative precision with fixed memory.
+ */
+class LatencyHistogram {
+public:
+    void record(uint64_t value) {
+        buckets_[bucket_for(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = max_.load(std::memory_order_relaxed);
+        while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t max() const {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    double mean() const {
+        uint64_t n = count();
+        return n == 0 ? 0.0 : static_cast<double>(sum_.load(std::memory_order_relaxed)) / n;
+    }
+
+    /**
+     * @brief Get the upper bound of the bucket holding a percentile
+     * @param p Percentile in [0, 100]
+     * @return Approximate value at the percentile
+     */
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+
+        auto rank = static_cast<uint64_t>(std::max(1.0, p / 100.0 * n));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(upper_bound(i), max());
+            }
+        }
+        return max();
+    }
+
+private:
+    static constexpr size_t kSubBits = 3;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBits;
+    static constexpr size_t kBuckets = 64 * kSubBuckets;
+
+    static size_t bucket_for(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        size_t exponent = 0;
+        for (uint64_t v = value; v > 1; v >>= 1) {
+            ++exponent;
+        }
+        size_t sub = static_cast<size_t>(value >> (exponent - kSubBits)) & (kSubBuckets - 1);
+        return std::min(kBuckets - 1, (exponent - kSubBits + 1) * kSubBuckets + sub);
+    }
+
+    static uint64_t upper_bound(size_t bucket) {
+        if (bucket < kSubBuckets) {
+            return bucket;
+        }
+        size_t exponent = bucket / kSubBuckets + kSubBits - 1;
+        uint64_t sub = bucket % kSubBuckets;
+        uint64_t base = uint64_t(1) << exponent;
+        return base + ((sub + 1) << (exponent - kSubBits)) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+} // namespace tools
+} // namespace pubsub
+
+#endif // CPP_PUBSUB_TOOLS_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,284 @@
+#include "pubsub/pubsub.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace pubsub;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Benchmark parameters
+ */
+struct BenchConfig {
+    size_t broker_threads = 0;
+    size_t publishers = 2;
+    size_t topics = 20000;
+    size_t subscriptions = 500;
+    size_t messages = 200000;
+    size_t payload_size = 64;
+    std::vector<HugePageMode> modes = {HugePageMode::Disabled, HugePageMode::Transparent, HugePageMode::Explicit};
+};
+
+/**
+ * @brief Counts data TLB misses of this process and the threads it starts afterwards
+ *
+ * Counts of inherited threads are only folded in once those threads exit,
+ * so read() is meaningful after the broker has been shut down.
+ */
+class TlbMissCounter {
+public:
+    TlbMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~TlbMissCounter() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    TlbMissCounter(const TlbMissCounter&) = delete;
+    TlbMissCounter& operator=(const TlbMissCounter&) = delete;
+
+    bool available() const {
+        return fd_ >= 0;
+    }
+
+    void start() {
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop() {
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    uint64_t read_count() const {
+        uint64_t value = 0;
+        if (fd_ < 0 || ::read(fd_, &value, sizeof(value)) != sizeof(value)) {
+            return 0;
+        }
+        return value;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+/**
+ * @brief Result of one run
+ */
+struct BenchResult {
+    double seconds = 0;
+    uint64_t tlb_misses = 0;
+    size_t delivered = 0;
+    size_t arena_mapped = 0;
+    size_t arena_huge = 0;
+};
+
+const char* mode_name(HugePageMode mode) {
+    switch (mode) {
+        case HugePageMode::Disabled:
+            return "disabled";
+        case HugePageMode::Transparent:
+            return "transparent";
+        case HugePageMode::Explicit:
+            return "explicit";
+    }
+    return "?";
+}
+
+bool parse_modes(const std::string& list, std::vector<HugePageMode>& modes) {
+    modes.clear();
+    std::stringstream ss(list);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        if (name == "disabled") {
+            modes.push_back(HugePageMode::Disabled);
+        } else if (name == "transparent") {
+            modes.push_back(HugePageMode::Transparent);
+        } else if (name == "explicit") {
+            modes.push_back(HugePageMode::Explicit);
+        } else {
+            return false;
+        }
+    }
+    return !modes.empty();
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --threads <n>          Broker worker threads (default: hardware concurrency)\n"
+              << "  --publishers <n>       Publisher threads (default 2)\n"
+              << "  --topics <n>           Number of topics (default 20000)\n"
+              << "  --subs <n>             Number of exact subscriptions (default 500)\n"
+              << "  --messages <n>         Messages per run (default 200000)\n"
+              << "  --payload-size <bytes> Payload size (default 64)\n"
+              << "  --modes <list>         Comma separated: disabled,transparent,explicit (default all)\n";
+}
+
+bool parse_args(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "--threads") {
+            config.broker_threads = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--publishers") {
+            config.publishers = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--topics") {
+            config.topics = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--subs") {
+            config.subscriptions = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--messages") {
+            config.messages = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--payload-size") {
+            config.payload_size = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--modes") {
+            if (!parse_modes(value, config.modes)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+BenchResult run(const BenchConfig& config, HugePageMode mode) {
+    // Opened before the broker starts so its worker threads inherit the counter
+    TlbMissCounter counter;
+
+    Broker& broker = Broker::instance();
+    BrokerConfig broker_config;
+    broker_config.thread_count = config.broker_threads;
+    broker_config.max_queue_size = 0;
+    broker_config.retain_messages = false;
+    broker_config.huge_pages = mode;
+    broker.initialize(broker_config);
+
+    std::vector<std::string> topics;
+    topics.reserve(config.topics);
+    for (size_t i = 0; i < config.topics; ++i) {
+        topics.push_back("bench/" + std::to_string(i / 100) + "/" + std::to_string(i));
+    }
+
+    std::atomic<size_t> received{0};
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    for (size_t i = 0; i < config.subscriptions; ++i) {
+        subscriptions.push_back(broker.subscribe(topics[i % topics.size()], [&received](const Message&) {
+            received.fetch_add(1, std::memory_order_relaxed);
+        }));
+    }
+
+    counter.start();
+    auto started = Clock::now();
+
+    std::vector<std::thread> publishers;
+    for (size_t p = 0; p < config.publishers; ++p) {
+        publishers.emplace_back([&, p]() {
+            std::mt19937_64 rng(p + 1);
+            std::uniform_int_distribution<size_t> pick(0, topics.size() - 1);
+            std::string payload(config.payload_size, 'x');
+            for (size_t i = p; i < config.messages; i += config.publishers) {
+                const std::string& topic = topics[pick(rng)];
+                broker.publish(topic, Message::create(topic, payload));
+            }
+        });
+    }
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+
+    while (broker.get_stats().queued_messages > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    BenchResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+    BrokerStats stats = broker.get_stats();
+    result.delivered = stats.delivered_messages;
+    result.arena_mapped = stats.arena_mapped_bytes;
+    result.arena_huge = stats.arena_huge_page_bytes;
+
+    for (auto& subscription : subscriptions) {
+        broker.unsubscribe(subscription);
+    }
+    broker.shutdown();
+
+    // Worker counts are folded in once the workers have exited
+    counter.stop();
+    result.tlb_misses = counter.read_count();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    bool counted = TlbMissCounter().available();
+    if (!counted) {
+        std::cerr << "dTLB miss counter unavailable (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+    }
+
+    std::cout << "mode          msg/s        dTLB misses  misses/msg  arena MiB  huge-page MiB\n";
+    for (HugePageMode mode : config.modes) {
+        BenchResult result = run(config, mode);
+        double rate = result.seconds > 0 ? config.messages / result.seconds : 0;
+
+        std::cout << std::left << std::setw(12) << mode_name(mode) << std::right << std::fixed
+                  << std::setprecision(0) << std::setw(9) << rate << "  ";
+        if (counted) {
+            std::cout << std::setw(15) << result.tlb_misses << "  " << std::setprecision(2) << std::setw(10)
+                      << static_cast<double>(result.tlb_misses) / std::max<size_t>(config.messages, 1);
+        } else {
+            std::cout << std::setw(15) << "n/a" << "  " << std::setw(10) << "n/a";
+        }
+        std::cout << std::setprecision(1) << std::setw(11) << result.arena_mapped / (1024.0 * 1024.0)
+                  << std::setw(15) << result.arena_huge / (1024.0 * 1024.0) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,355 @@
+#include "pubsub/pubsub.hpp"
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pubsub;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Workload description
+ */
+struct LoadConfig {
+    size_t broker_threads = 0;
+    size_t queue_size = 100000;
+    size_t publishers = 1;
+    double duration_s = 5.0;
+    double rate = 0;              // messages per second per publisher (0 = unthrottled)
+    size_t depth = 3;             // topic tree depth
+    size_t width = 10;            // children per level
+    double zipf = 1.0;            // topic popularity exponent (0 = uniform)
+    size_t subscriptions = 100;
+    double exact_ratio = 0.6;
+    double plus_ratio = 0.3;      // remainder uses '#'
+    std::string payload_dist = "fixed";
+    size_t payload_size = 256;    // mean (or fixed) payload size in bytes
+    size_t burst_size = 1;        // messages sent back to back
+    uint64_t burst_idle_us = 0;   // pause between bursts
+    uint64_t seed = 42;
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --threads <n>          Broker worker threads (default: hardware concurrency)\n"
+              << "  --queue <n>            Broker max queue size (default 100000)\n"
+              << "  --publishers <n>       Publisher threads (default 1)\n"
+              << "  --duration <s>         Run time in seconds (default 5)\n"
+              << "  --rate <msg/s>         Rate per publisher, 0 = unthrottled (default 0)\n"
+              << "  --depth <n>            Topic tree depth (default 3)\n"
+              << "  --width <n>            Children per topic level (default 10)\n"
+              << "  --zipf <s>             Topic popularity exponent, 0 = uniform (default 1.0)\n"
+              << "  --subs <n>             Number of subscriptions (default 100)\n"
+              << "  --exact <ratio>        Fraction of exact subscriptions (default 0.6)\n"
+              << "  --plus <ratio>         Fraction of '+' subscriptions; rest use '#' (default 0.3)\n"
+              << "  --payload <dist>       fixed | uniform | lognormal (default fixed)\n"
+              << "  --payload-size <bytes> Mean payload size (default 256)\n"
+              << "  --burst <n>            Messages per burst (default 1)\n"
+              << "  --burst-idle <us>      Idle time between bursts (default 0)\n"
+              << "  --seed <n>             Random seed (default 42)\n";
+}
+
+bool parse_args(int argc, char* argv[], LoadConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const char* value = argv[++i];
+
+        if (arg == "--threads") {
+            config.broker_threads = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--queue") {
+            config.queue_size = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--publishers") {
+            config.publishers = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--duration") {
+            config.duration_s = std::atof(value);
+        } else if (arg == "--rate") {
+            config.rate = std::atof(value);
+        } else if (arg == "--depth") {
+            config.depth = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--width") {
+            config.width = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--zipf") {
+            config.zipf = std::atof(value);
+        } else if (arg == "--subs") {
+            config.subscriptions = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--exact") {
+            config.exact_ratio = std::atof(value);
+        } else if (arg == "--plus") {
+            config.plus_ratio = std::atof(value);
+        } else if (arg == "--payload") {
+            config.payload_dist = value;
+        } else if (arg == "--payload-size") {
+            config.payload_size = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--burst") {
+            config.burst_size = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+        } else if (arg == "--burst-idle") {
+            config.burst_idle_us = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else {
+            return false;
+        }
+    }
+
+    return config.payload_dist == "fixed" || config.payload_dist == "uniform" ||
+           config.payload_dist == "lognormal";
+}
+
+/**
+ * @brief Leaf topics of a tree such as "l0_3/l1_7/l2_1"
+ */
+std::vector<std::vector<std::string>> build_topic_tree(size_t depth, size_t width) {
+    std::vector<std::vector<std::string>> leaves{{}};
+
+    for (size_t level = 0; level < depth; ++level) {
+        std::vector<std::vector<std::string>> next;
+        next.reserve(leaves.size() * width);
+        for (const auto& prefix : leaves) {
+            for (size_t child = 0; child < width; ++child) {
+                auto path = prefix;
+                path.push_back("l" + std::to_string(level) + "_" + std::to_string(child));
+                next.push_back(std::move(path));
+            }
+        }
+        leaves = std::move(next);
+    }
+
+    return leaves;
+}
+
+std::string join_levels(const std::vector<std::string>& levels, size_t count) {
+    std::string result;
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            result += '/';
+        }
+        result += levels[i];
+    }
+    return result;
+}
+
+/**
+ * @brief Samples ranks 0..n-1 with P(k) proportional to 1 / (k + 1)^s
+ */
+class ZipfSampler {
+public:
+    ZipfSampler(size_t n, double exponent)
+        : cdf_(n) {
+        double total = 0;
+        for (size_t k = 0; k < n; ++k) {
+            total += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+            cdf_[k] = total;
+        }
+        for (auto& value : cdf_) {
+            value /= total;
+        }
+    }
+
+    template<typename Rng>
+    size_t operator()(Rng& rng) const {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+        return std::min(static_cast<size_t>(it - cdf_.begin()), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+template<typename Rng>
+size_t sample_payload_size(const LoadConfig& config, Rng& rng) {
+    if (config.payload_dist == "uniform") {
+        return std::uniform_int_distribution<size_t>(0, config.payload_size * 2)(rng);
+    }
+    if (config.payload_dist == "lognormal") {
+        // sigma = 1 gives a heavy right tail; mu chosen so the mean is payload_size
+        double mu = std::log(static_cast<double>(std::max<size_t>(1, config.payload_size))) - 0.5;
+        return static_cast<size_t>(std::lognormal_distribution<double>(mu, 1.0)(rng));
+    }
+    return config.payload_size;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    BrokerConfig broker_config;
+    broker_config.thread_count = config.broker_threads;
+    broker_config.max_queue_size = config.queue_size;
+    broker_config.retain_messages = false;
+
+    Broker& broker = Broker::instance();
+    if (!broker.initialize(broker_config)) {
+        std::cerr << "Failed to initialize broker" << std::endl;
+        return 1;
+    }
+
+    auto leaves = build_topic_tree(config.depth, config.width);
+    std::vector<std::string> topics;
+    topics.reserve(leaves.size());
+    for (const auto& leaf : leaves) {
+        topics.push_back(join_levels(leaf, leaf.size()));
+    }
+
+    // Shuffle so popularity rank is independent of tree position
+    std::mt19937_64 rng(config.seed);
+    std::vector<size_t> order(leaves.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+
+    ZipfSampler popularity(topics.size(), config.zipf);
+
+    // Subscriptions follow topic popularity too, mixing exact, '+' and '#'
+    tools::LatencyHistogram delivery_latency;
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    size_t exact_count = 0;
+    size_t plus_count = 0;
+    size_t hash_count = 0;
+
+    for (size_t i = 0; i < config.subscriptions; ++i) {
+        const auto& leaf = leaves[order[popularity(rng)]];
+        double kind = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+
+        std::string pattern;
+        if (kind < config.exact_ratio) {
+            pattern = join_levels(leaf, leaf.size());
+            exact_count++;
+        } else if (kind < config.exact_ratio + config.plus_ratio) {
+            auto levels = leaf;
+            levels[std::uniform_int_distribution<size_t>(0, levels.size() - 1)(rng)] = "+";
+            pattern = join_levels(levels, levels.size());
+            plus_count++;
+        } else {
+            size_t prefix = std::uniform_int_distribution<size_t>(0, leaf.size() - 1)(rng);
+            pattern = prefix == 0 ? "#" : join_levels(leaf, prefix) + "/#";
+            hash_count++;
+        }
+
+        subscriptions.push_back(broker.subscribe(pattern, [&delivery_latency](const Message& msg) {
+            auto age = TickClock::elapsed(msg.timestamp_ticks(), TickClock::now());
+            delivery_latency.record(static_cast<uint64_t>(age.count()));
+        }));
+    }
+
+    std::cout << "Topics: " << topics.size() << " (depth " << config.depth << ", width " << config.width
+              << ", zipf " << config.zipf << ")\n"
+              << "Subscriptions: " << exact_count << " exact, " << plus_count << " '+', "
+              << hash_count << " '#'\n"
+              << "Running " << config.publishers << " publisher(s) for " << config.duration_s << " s..."
+              << std::endl;
+
+    // Publishers
+    tools::LatencyHistogram publish_latency;
+    std::atomic<size_t> published{0};
+    std::atomic<size_t> dropped{0};
+    std::atomic<size_t> payload_bytes{0};
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> publishers;
+    for (size_t p = 0; p < config.publishers; ++p) {
+        publishers.emplace_back([&, p]() {
+            std::mt19937_64 local_rng(config.seed + p + 1);
+            const auto interval = config.rate > 0
+                ? std::chrono::duration_cast<Clock::duration>(
+                      std::chrono::duration<double>(config.burst_size / config.rate))
+                : Clock::duration::zero();
+            auto next_burst = Clock::now();
+
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (size_t b = 0; b < config.burst_size; ++b) {
+                    const auto& topic = topics[order[popularity(local_rng)]];
+                    size_t size = sample_payload_size(config, local_rng);
+                    auto msg = Message::create(topic, Buffer::adopt(std::string(size, 'x')));
+
+                    auto start = Clock::now();
+                    bool ok = broker.publish(topic, std::move(msg));
+                    publish_latency.record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+
+                    if (ok) {
+                        published.fetch_add(1, std::memory_order_relaxed);
+                        payload_bytes.fetch_add(size, std::memory_order_relaxed);
+                    } else {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+
+                if (config.burst_idle_us > 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(config.burst_idle_us));
+                }
+                if (interval > Clock::duration::zero()) {
+                    next_burst += interval;
+                    std::this_thread::sleep_until(next_burst);
+                }
+            }
+        });
+    }
+
+    auto started = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(config.duration_s));
+    stop = true;
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+    auto publish_elapsed = Clock::now() - started;
+
+    // Drain
+    while (broker.get_stats().queued_messages > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double seconds = std::chrono::duration<double>(publish_elapsed).count();
+
+    BrokerStats stats = broker.get_stats();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\nPublished:        " << published << " (" << published / seconds << " msg/s, "
+              << payload_bytes / seconds / (1024 * 1024) << " MiB/s)\n"
+              << "Dropped:          " << dropped << "\n"
+              << "Delivered:        " << stats.delivered_messages << " (" << stats.delivered_messages / seconds
+              << " deliveries/s)\n"
+              << "\nStage latency (us)       mean      p50      p99    p99.9      max\n";
+
+    auto print_row = [](const char* name, const tools::LatencyHistogram& h) {
+        std::cout << name;
+        for (double ns : {h.mean(), static_cast<double>(h.percentile(50)), static_cast<double>(h.percentile(99)),
+                          static_cast<double>(h.percentile(99.9)), static_cast<double>(h.max())}) {
+            std::cout << ' ';
+            std::cout.width(8);
+            std::cout << ns / 1000.0;
+        }
+        std::cout << "\n";
+    };
+    print_row("  publish call        ", publish_latency);
+    print_row("  publish to callback ", delivery_latency);
+    std::cout << std::flush;
+
+    for (auto& subscription : subscriptions) {
+        broker.unsubscribe(subscription);
+    }
+    broker.shutdown();
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "pubsub/pubsub.hpp"
+#include "latency_histogram.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace pubsub;
+
+namespace {
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " <capture-file> [options]\n"
+              << "  --speed <factor>   Replay at a multiple of the original speed (default 1.0)\n"
+              << "  --max              Replay as fast as possible\n"
+              << "  --threads <n>      Broker worker threads (default: hardware concurrency)\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::string path = argv[1];
+    ReplayOptions options;
+    size_t threads = 0;
+
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            options.speed = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--max") == 0) {
+            options.speed = 0;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<size_t>(std::atol(argv[++i]));
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    CaptureReader reader(path);
+    if (!reader.is_open()) {
+        std::cerr << "Cannot open capture file '" << path << "'" << std::endl;
+        return 1;
+    }
+
+    if (!initialize(threads)) {
+        std::cerr << "Failed to initialize PubSub library" << std::endl;
+        return 1;
+    }
+
+    Broker& broker = Broker::instance();
+
+    // End-to-end latency: message creation to callback invocation
+    tools::LatencyHistogram latency;
+    auto subscription = broker.subscribe("#", [&latency](const Message& msg) {
+        auto age = TickClock::elapsed(msg.timestamp_ticks(), TickClock::now());
+        latency.record(static_cast<uint64_t>(age.count()));
+    });
+
+    ReplayStats stats = replay_capture(broker, reader, options);
+
+    // Let the workers drain the queue before reporting
+    while (broker.get_stats().queued_messages > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    double seconds = std::chrono::duration<double>(stats.elapsed).count();
+    std::cout << "Records:        " << stats.records << "\n"
+              << "Published:      " << stats.published << "\n"
+              << "Dropped:        " << stats.dropped << "\n"
+              << "Elapsed:        " << seconds << " s\n"
+              << "Throughput:     " << (seconds > 0 ? stats.published / seconds : 0) << " msg/s\n"
+              << "Max lag:        " << std::chrono::duration<double, std::micro>(stats.max_lag).count() << " us\n"
+              << "Delivered:      " << latency.count() << "\n"
+              << "Latency mean:   " << latency.mean() / 1000.0 << " us\n"
+              << "Latency p50:    " << latency.percentile(50) / 1000.0 << " us\n"
+              << "Latency p99:    " << latency.percentile(99) / 1000.0 << " us\n"
+              << "Latency p99.9:  " << latency.percentile(99.9) / 1000.0 << " us\n"
+              << "Latency max:    " << latency.max() / 1000.0 << " us" << std::endl;
+
+    broker.unsubscribe(subscription);
+    shutdown();
+
+    return 0;
+}